@@ -0,0 +1,63 @@
+// Compares the cost of finding the differences between two versions of a loop-heavy graph by
+// hashing both versions in full, by diff_graphs(), and by diff_digests().
+//
+// The graph consists of a number of loops, each of which is entered from a vertex which has no
+// predecessors. The new version of the graph has one additional edge in the first loop.
+//
+// Usage: diff-bench [loops [loop-length]]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+
+#include "diff.hpp"
+#include "graph_builders.hpp"
+#include "hash.hpp"
+#include "vertex.hpp"
+
+namespace {
+
+    using clock_type = std::chrono::steady_clock;
+
+    double milliseconds_since (clock_type::time_point const start) {
+        return std::chrono::duration<double, std::milli> (clock_type::now () - start).count ();
+    }
+
+    /// Runs \p f and reports the time taken and the number of bytes hashed.
+    template <typename Function>
+    void measure (char const * const name, Function f) {
+        auto const bytes = hash::total ();
+        auto const start = clock_type::now ();
+        f ();
+        auto const ms = milliseconds_since (start);
+        std::cout << name << ": " << ms << " ms, " << hash::total () - bytes << " bytes hashed"
+                  << std::endl;
+    }
+
+} // end anonymous namespace
+
+int main (int argc, char ** argv) {
+    std::size_t const loops = argc > 1 ? std::stoul (argv[1]) : 2000U;
+    std::size_t const length = argc > 2 ? std::stoul (argv[2]) : 100U;
+    if (length < 2U) {
+        std::cerr << "loop-length must be at least 2\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Building two graphs of " << loops << " loops of " << length << " vertices..."
+              << std::endl;
+    std::list<vertex> const old_graph = make_loops (loops, length, false);
+    std::list<vertex> const new_graph = make_loops (loops, length, true);
+    auto const old_pointers = pointers (old_graph);
+    auto const new_pointers = pointers (new_graph);
+    digest_set const old_digests = graph_digests (old_pointers);
+
+    measure ("two graph_digests() passes", [&] () {
+        graph_digests (old_pointers);
+        graph_digests (new_pointers);
+    });
+    measure ("diff_graphs()", [&] () { diff_graphs (old_pointers, new_pointers); });
+    measure ("diff_digests()", [&] () { diff_digests (old_digests, new_pointers); });
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+// Measures the effect of relaid_graph on the time taken to hash every vertex of a large, randomly
+// generated, acyclic graph.
+//
+// Usage: relayout-bench [vertices [edges-per-vertex]]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "memhash.hpp"
+#include "relayout.hpp"
+#include "vertex.hpp"
+
+namespace {
+
+    using clock_type = std::chrono::steady_clock;
+
+    double seconds_since (clock_type::time_point const start) {
+        return std::chrono::duration<double> (clock_type::now () - start).count ();
+    }
+
+    /// Creates a graph in which each vertex has edges to randomly chosen vertices of lower rank.
+    /// The vertices are created in an order unrelated to their rank so that traversal jumps
+    /// around the heap.
+    std::list<vertex> make_graph (std::size_t const vertices, std::size_t const edges) {
+        std::mt19937_64 rng{1};
+        std::vector<std::size_t> creation_order (vertices);
+        std::iota (std::begin (creation_order), std::end (creation_order), std::size_t{0});
+        std::shuffle (std::begin (creation_order), std::end (creation_order), rng);
+
+        std::list<vertex> graph;
+        std::vector<vertex *> by_rank (vertices);
+        for (std::size_t const rank : creation_order) {
+            by_rank[rank] = &graph.emplace_back ("v" + std::to_string (rank));
+        }
+        for (auto rank = std::size_t{1}; rank < vertices; ++rank) {
+            std::uniform_int_distribution<std::size_t> lower{0, rank - 1U};
+            for (auto e = std::size_t{0}; e < edges; ++e) {
+                by_rank[rank]->add_edge (by_rank[lower (rng)]);
+            }
+        }
+        return graph;
+    }
+
+    /// Hashes each of the vertices in [first, last) and returns the time taken.
+    template <typename Iterator>
+    double hash_all (Iterator first, Iterator last) {
+        memoized_hashes table;
+        auto const start = clock_type::now ();
+        std::for_each (first, last, [&table] (vertex const & v) { vertex_hash (&v, &table); });
+        return seconds_since (start);
+    }
+
+} // end anonymous namespace
+
+int main (int argc, char ** argv) {
+    std::size_t const vertices = argc > 1 ? std::stoul (argv[1]) : 2'000'000U;
+    std::size_t const edges = argc > 2 ? std::stoul (argv[2]) : 5U;
+
+    std::cout << "Building a graph with " << vertices << " vertices and " << vertices * edges
+              << " edges..." << std::endl;
+    std::list<vertex> const graph = make_graph (vertices, edges);
+    std::vector<vertex const *> pointers;
+    pointers.reserve (vertices);
+    for (vertex const & v : graph) {
+        pointers.push_back (&v);
+    }
+
+    std::cout << "creation order: hash " << hash_all (std::begin (graph), std::end (graph))
+              << "s" << std::endl;
+
+    struct {
+        char const * name;
+        layout_order order;
+    } const layouts[] = {
+        {"depth-first", layout_order::depth_first},
+        {"breadth-first", layout_order::breadth_first},
+        {"reverse Cuthill-McKee", layout_order::reverse_cuthill_mckee},
+    };
+    for (auto const & layout : layouts) {
+        auto const start = clock_type::now ();
+        relaid_graph const rg{pointers, layout.order};
+        auto const relayout_time = seconds_since (start);
+        auto const & rv = rg.vertices ();
+        std::cout << layout.name << ": relayout " << relayout_time << "s, hash "
+                  << hash_all (std::begin (rv), std::end (rv)) << 's' << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
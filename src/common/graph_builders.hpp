@@ -0,0 +1,49 @@
+#ifndef GRAPH_BUILDERS_HPP
+#define GRAPH_BUILDERS_HPP
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "vertex.hpp"
+
+/// Returns the address of each vertex of \p graph in order.
+inline std::vector<vertex const *> pointers (std::list<vertex> const & graph) {
+    std::vector<vertex const *> result;
+    result.reserve (graph.size ());
+    for (vertex const & v : graph) {
+        result.push_back (&v);
+    }
+    return result;
+}
+
+/// Builds a graph of \p loops loops of \p length vertices, each entered from a vertex which has no
+/// predecessors. The vertices of loop l are named "l<l>_entry" and "l<l>_0" to "l<l>_<length-1>".
+///
+/// \param loops  The number of loops.
+/// \param length  The number of vertices in each loop. Must be at least 1.
+/// \param changed  If true, the first loop gains an edge from its middle vertex back to its first.
+inline std::list<vertex> make_loops (std::size_t const loops, std::size_t const length,
+                                     bool const changed) {
+    std::list<vertex> graph;
+    for (auto l = std::size_t{0}; l < loops; ++l) {
+        auto const prefix = "l" + std::to_string (l) + '_';
+        vertex & entry = graph.emplace_back (prefix + "entry");
+        std::vector<vertex *> members;
+        members.reserve (length);
+        for (auto m = std::size_t{0}; m < length; ++m) {
+            members.push_back (&graph.emplace_back (prefix + std::to_string (m)));
+        }
+        entry.add_edge (members.front ());
+        for (auto m = std::size_t{0}; m < length; ++m) {
+            members[m]->add_edge (members[(m + 1U) % length]);
+        }
+        if (changed && l == 0U) {
+            members[length / 2U]->add_edge (members.front ());
+        }
+    }
+    return graph;
+}
+
+#endif // GRAPH_BUILDERS_HPP
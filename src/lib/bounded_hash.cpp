@@ -0,0 +1,29 @@
+#include "bounded_hash.hpp"
+
+#include "trace.hpp"
+#include "vertex.hpp"
+
+hash::digest bounded_vertex_hash (vertex const * const v, std::size_t const horizon,
+                                  bounded_memoized_hashes * const table) {
+    trace ("Computing bounded hash for ", *v, " (horizon ", horizon, ')');
+    auto const table_pos = table->find (bounded_key{v, horizon});
+    if (table_pos != table->end ()) {
+        trace ("Returning pre-computed bounded hash for ", *v);
+        return table_pos->second;
+    }
+
+    // The leading bound tag distinguishes this digest from a full digest (which always starts
+    // with a vertex). Including the horizon keeps digests of different depths apart.
+    hash h;
+    h.update_bound (horizon);
+    h.update_vertex (*v);
+    if (horizon > 0U) {
+        for (vertex const * const out : v->out_edges ()) {
+            h.update_digest (bounded_vertex_hash (out, horizon - 1U, table));
+        }
+    }
+    h.update_end ();
+
+    // Re-lookup rather than holding an iterator: the recursive calls may have rehashed the table.
+    return (*table)[bounded_key{v, horizon}] = h.finalize ();
+}
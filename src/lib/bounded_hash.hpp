@@ -0,0 +1,43 @@
+#ifndef BOUNDED_HASH_HPP
+#define BOUNDED_HASH_HPP
+
+#include <cstdlib>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "hash.hpp"
+
+class vertex;
+
+/// A (vertex, horizon) pair: the key for a memoized bounded digest.
+using bounded_key = std::pair<vertex const *, std::size_t>;
+
+struct bounded_key_hash {
+    std::size_t operator() (bounded_key const & k) const noexcept {
+        auto const h = std::hash<vertex const *>{}(k.first);
+        return h ^ (std::hash<std::size_t>{}(k.second) + 0x9e3779b9U + (h << 6U) + (h >> 2U));
+    }
+};
+
+using bounded_memoized_hashes = std::unordered_map<bounded_key, hash::digest, bounded_key_hash>;
+
+/// Computes a digest of graph vertex \p v which incorporates only those vertices that lie
+/// within \p horizon hops of it. The digest is that of the tree formed by unrolling the graph
+/// from \p v to depth \p horizon, so it needs no back-references and is independent of the path
+/// by which \p v was reached. Vertices whose full digests (see vertex_hash()) are equal always
+/// have equal bounded digests; the converse does not hold, which makes the result suitable for
+/// cheaply bucketing vertices before a full comparison. Bounded digests are encoded such that
+/// they can never be equal to a full digest.
+///
+/// \param v  The vertex whose bounded digest is to be computed.
+/// \param horizon  The maximum number of hops from \p v to be included. A horizon of 0 covers
+///   \p v alone.
+/// \param table  Used to record memoized digests for each (vertex, horizon) pair. Computing the
+///   digest for horizon K records those of the successors at horizon K-1, so pass the same
+///   object to multiple calls to this function to improve performance.
+/// \returns The bounded digest for vertex \p v.
+hash::digest bounded_vertex_hash (vertex const * const v, std::size_t const horizon,
+                                  bounded_memoized_hashes * const table);
+
+#endif // BOUNDED_HASH_HPP
@@ -0,0 +1,50 @@
+#include "consing_builder.hpp"
+
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+std::size_t consing_builder::structure_hash::operator() (vertex const * const v) const noexcept {
+    auto result = std::hash<std::string>{}(v->name ());
+    for (vertex const * const out : v->out_edges ()) {
+        // The successors are themselves shared so we can simply hash their addresses.
+        result = result * 31U + std::hash<vertex const *>{}(out);
+    }
+    return result;
+}
+
+bool consing_builder::structure_equal::operator() (vertex const * const a,
+                                                   vertex const * const b) const noexcept {
+    return a->name () == b->name () && a->out_edges () == b->out_edges ();
+}
+
+vertex const * consing_builder::make (std::string const & name,
+                                      std::initializer_list<vertex const *> adjacent) {
+    return this->make (name, std::vector<vertex const *>{adjacent});
+}
+
+vertex const * consing_builder::make (std::string const & name,
+                                      std::vector<vertex const *> adjacent) {
+    for (vertex const * const out : adjacent) {
+        auto const pos = shared_.find (out);
+        if (pos == shared_.end () || *pos != out) {
+            throw std::invalid_argument ("the out-edges of vertex \"" + name +
+                                         "\" must lead to shared vertices");
+        }
+    }
+
+    ++requests_;
+    vertex probe{name, std::move (adjacent)};
+    auto const pos = shared_.find (&probe);
+    if (pos != shared_.end ()) {
+        ++hits_;
+        return *pos;
+    }
+    vertex const * const v = &graph_.emplace_back (std::move (probe));
+    shared_.insert (v);
+    return v;
+}
+
+vertex & consing_builder::open (std::string const & name) {
+    return graph_.emplace_back (name);
+}
@@ -0,0 +1,58 @@
+#ifndef CONSING_BUILDER_HPP
+#define CONSING_BUILDER_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <list>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "vertex.hpp"
+
+/// Builds a graph in which structurally identical acyclic vertices are created only once
+/// ("hash-consing"). A request for a vertex with the same name and out-edges as one that already
+/// exists returns the existing vertex. Since vertex_hash() depends only on the structure reachable
+/// from a vertex, every handle returned by the builder has the same digest as the corresponding
+/// vertex of a graph built without sharing, but the shared vertices are stored and hashed once.
+///
+/// Sharing is only sound for acyclic vertices, so the out-edges of a shared vertex are fixed when
+/// it is created and must all lead to other shared vertices. Vertices which may be part of a cycle
+/// are created with open() and are never shared; they may have edges to any vertex.
+class consing_builder {
+public:
+    /// Returns a shared vertex with the given name and out-edges, creating it if necessary.
+    ///
+    /// \param name  The name of the vertex.
+    /// \param adjacent  The vertex's out-edges. Each must have been returned by make().
+    /// \returns A vertex with name \p name and out-edges \p adjacent.
+    vertex const * make (std::string const & name,
+                         std::initializer_list<vertex const *> adjacent = {});
+    vertex const * make (std::string const & name, std::vector<vertex const *> adjacent);
+
+    /// Creates a new vertex which won't be shared. Edges may be added to it at any time.
+    vertex & open (std::string const & name);
+
+    /// The vertices created by the builder.
+    std::list<vertex> const & vertices () const noexcept { return graph_; }
+
+    /// The number of calls to make().
+    std::size_t requests () const noexcept { return requests_; }
+    /// The number of calls to make() which returned an existing vertex.
+    std::size_t hits () const noexcept { return hits_; }
+
+private:
+    struct structure_hash {
+        std::size_t operator() (vertex const * v) const noexcept;
+    };
+    struct structure_equal {
+        bool operator() (vertex const * a, vertex const * b) const noexcept;
+    };
+
+    std::list<vertex> graph_;
+    std::unordered_set<vertex const *, structure_hash, structure_equal> shared_;
+    std::size_t requests_ = 0;
+    std::size_t hits_ = 0;
+};
+
+#endif // CONSING_BUILDER_HPP
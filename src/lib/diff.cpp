@@ -0,0 +1,275 @@
+#include "diff.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "config.hpp"
+#include "memhash.hpp"
+#include "scc.hpp"
+#include "vertex.hpp"
+
+namespace {
+
+    using name_index = std::unordered_map<std::string, vertex const *>;
+
+    name_index index_by_name (std::vector<vertex const *> const & graph) {
+        name_index result;
+        result.reserve (graph.size ());
+        for (vertex const * const v : graph) {
+            if (!result.emplace (v->name (), v).second) {
+                throw std::invalid_argument ("duplicate vertex name \"" + v->name () + '"');
+            }
+        }
+        return result;
+    }
+
+    /// Returns true if vertices \p a and \p b have successors with the same names in the same
+    /// order.
+    bool same_successors (vertex const & a, vertex const & b) {
+        auto const & ae = a.out_edges ();
+        auto const & be = b.out_edges ();
+        return std::equal (std::begin (ae), std::end (ae), std::begin (be), std::end (be),
+                           [] (vertex const * const x, vertex const * const y) {
+                               return x->name () == y->name ();
+                           });
+    }
+
+    void sort_names (graph_diff * const d) {
+        std::sort (std::begin (d->added), std::end (d->added));
+        std::sort (std::begin (d->removed), std::end (d->removed));
+        std::sort (std::begin (d->changed), std::end (d->changed));
+        std::sort (std::begin (d->root_causes), std::end (d->root_causes));
+    }
+
+    void find_removed (digest_set const & old_digests, name_index const & new_index,
+                       graph_diff * const d) {
+        for (auto const & od : old_digests) {
+            if (new_index.find (od.first) == new_index.end ()) {
+                d->removed.push_back (od.first);
+            }
+        }
+    }
+
+    /// Finds the changed vertices from which no changed vertex outside of their own strongly
+    /// connected component can be reached.
+    std::vector<std::string>
+    root_cause_components (std::unordered_set<vertex const *> const & changed) {
+        std::vector<std::string> result;
+        std::vector<vertex const *> const members (std::begin (changed), std::end (changed));
+        for (auto const & component : strongly_connected_components (members)) {
+            std::unordered_set<vertex const *> const inside (std::begin (component),
+                                                             std::end (component));
+            bool const is_root =
+                std::none_of (std::begin (component), std::end (component), [&] (vertex const * v) {
+                    auto const & out = v->out_edges ();
+                    return std::any_of (std::begin (out), std::end (out), [&] (vertex const * w) {
+                        return changed.count (w) > 0U && inside.count (w) == 0U;
+                    });
+                });
+            if (is_root) {
+                for (vertex const * const v : component) {
+                    result.push_back (v->name ());
+                }
+            }
+        }
+        return result;
+    }
+
+} // end anonymous namespace
+
+digest_set graph_digests (std::vector<vertex const *> const & graph) {
+    digest_set result;
+    memoized_hashes table;
+    for (vertex const * const v : graph) {
+        result[v->name ()] = vertex_hash (v, &table);
+    }
+    return result;
+}
+
+void write_digests (std::ostream & os, digest_set const & digests) {
+    std::vector<digest_set::value_type const *> order;
+    order.reserve (digests.size ());
+    for (auto const & d : digests) {
+        order.push_back (&d);
+    }
+    std::sort (std::begin (order), std::end (order),
+               [] (digest_set::value_type const * a, digest_set::value_type const * b) {
+                   return a->first < b->first;
+               });
+
+    auto const flags = os.flags ();
+    for (digest_set::value_type const * const d : order) {
+#ifdef FNV1_HASH_ENABLED
+        os << d->first << '\t' << std::hex << d->second << std::dec << '\n';
+#else
+        os << d->first << '\t' << d->second << '\n';
+#endif // FNV1_HASH_ENABLED
+    }
+    os.flags (flags);
+}
+
+digest_set read_digests (std::istream & is) {
+    digest_set result;
+    std::string line;
+    while (std::getline (is, line)) {
+        auto const tab = line.find ('\t');
+        if (tab == std::string::npos) {
+            throw std::runtime_error ("malformed digest line: \"" + line + '"');
+        }
+        auto const text = line.substr (tab + 1U);
+#ifdef FNV1_HASH_ENABLED
+        std::size_t end = 0;
+        hash::digest const digest = std::stoull (text, &end, 16);
+        if (end != text.length ()) {
+            throw std::runtime_error ("malformed digest: \"" + text + '"');
+        }
+#else
+        hash::digest const & digest = text;
+#endif // FNV1_HASH_ENABLED
+        result[line.substr (0, tab)] = digest;
+    }
+    return result;
+}
+
+graph_diff diff_graphs (std::vector<vertex const *> const & old_graph,
+                        std::vector<vertex const *> const & new_graph) {
+    name_index const old_index = index_by_name (old_graph);
+    name_index const new_index = index_by_name (new_graph);
+
+    graph_diff result;
+    std::unordered_map<vertex const *, std::vector<vertex const *>> predecessors;
+    predecessors.reserve (new_graph.size ());
+    std::vector<vertex const *> work;
+    std::unordered_set<vertex const *> reached;
+    for (vertex const * const v : new_graph) {
+        for (vertex const * const out : v->out_edges ()) {
+            predecessors[out].push_back (v);
+        }
+        auto const pos = old_index.find (v->name ());
+        if (pos == old_index.end ()) {
+            result.added.push_back (v->name ());
+        } else if (!same_successors (*pos->second, *v)) {
+            result.root_causes.push_back (v->name ());
+            work.push_back (v);
+            reached.insert (v);
+        }
+    }
+    for (vertex const * const v : old_graph) {
+        if (new_index.find (v->name ()) == new_index.end ()) {
+            result.removed.push_back (v->name ());
+        }
+    }
+
+    // Everything from which a root cause can be reached has changed.
+    while (!work.empty ()) {
+        vertex const * const v = work.back ();
+        work.pop_back ();
+        for (vertex const * const p : predecessors[v]) {
+            if (reached.insert (p).second) {
+                work.push_back (p);
+            }
+        }
+    }
+    for (vertex const * const v : new_graph) {
+        if (reached.count (v) > 0U && old_index.find (v->name ()) != old_index.end ()) {
+            result.changed.push_back (v->name ());
+        }
+    }
+
+    sort_names (&result);
+    return result;
+}
+
+graph_diff diff_digests (digest_set const & old_digests,
+                         std::vector<vertex const *> const & new_graph) {
+    name_index const new_index = index_by_name (new_graph);
+
+    enum class state { unknown, same, changed, added };
+    std::unordered_map<vertex const *, state> states;
+    std::unordered_set<vertex const *> has_predecessor;
+    states.reserve (new_graph.size ());
+    has_predecessor.reserve (new_graph.size ());
+    for (vertex const * const v : new_graph) {
+        states.emplace (v, state::unknown);
+        for (vertex const * const out : v->out_edges ()) {
+            if (out != v) {
+                has_predecessor.insert (out);
+            }
+        }
+    }
+
+    // Marks v and everything reachable from it as unchanged.
+    auto const mark_same = [&states] (vertex const * const v) {
+        std::vector<vertex const *> work{v};
+        while (!work.empty ()) {
+            vertex const * const w = work.back ();
+            work.pop_back ();
+            state & s = states[w];
+            if (s == state::unknown) {
+                s = state::same;
+                work.insert (std::end (work), std::begin (w->out_edges ()),
+                             std::end (w->out_edges ()));
+            }
+        }
+    };
+
+    // Start at the vertices without predecessors: if they're unchanged, so is everything beneath
+    // them. Any vertices which are still unclassified after that (those on cycles which can't be
+    // reached from such a vertex) are visited in the order given.
+    std::vector<vertex const *> order;
+    order.reserve (new_graph.size () * 2U);
+    std::copy_if (std::begin (new_graph), std::end (new_graph), std::back_inserter (order),
+                  [&has_predecessor] (vertex const * const v) {
+                      return has_predecessor.count (v) == 0U;
+                  });
+    order.insert (std::end (order), std::begin (new_graph), std::end (new_graph));
+
+    memoized_hashes table;
+    std::vector<vertex const *> work;
+    for (vertex const * const start : order) {
+        work.push_back (start);
+        while (!work.empty ()) {
+            vertex const * const v = work.back ();
+            work.pop_back ();
+            state & s = states[v];
+            if (s != state::unknown) {
+                continue;
+            }
+            auto const pos = old_digests.find (v->name ());
+            if (pos == old_digests.end ()) {
+                s = state::added;
+            } else if (vertex_hash (v, &table) == pos->second) {
+                mark_same (v);
+                continue;
+            } else {
+                s = state::changed;
+            }
+            // This vertex differs: descend to find out why.
+            work.insert (std::end (work), std::rbegin (v->out_edges ()),
+                         std::rend (v->out_edges ()));
+        }
+    }
+
+    graph_diff result;
+    std::unordered_set<vertex const *> changed;
+    for (vertex const * const v : new_graph) {
+        switch (states[v]) {
+        case state::added: result.added.push_back (v->name ()); break;
+        case state::changed:
+            result.changed.push_back (v->name ());
+            changed.insert (v);
+            break;
+        case state::unknown:
+        case state::same: break;
+        }
+    }
+    find_removed (old_digests, new_index, &result);
+    result.root_causes = root_cause_components (changed);
+
+    sort_names (&result);
+    return result;
+}
@@ -0,0 +1,64 @@
+#ifndef DIFF_HPP
+#define DIFF_HPP
+
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hash.hpp"
+
+class vertex;
+
+/// The differences between two versions of a graph whose vertices are matched by name. Each
+/// collection is sorted by name.
+struct graph_diff {
+    /// Vertices which are present only in the new graph.
+    std::vector<std::string> added;
+    /// Vertices which are present only in the old graph.
+    std::vector<std::string> removed;
+    /// Vertices which are present in both graphs but whose digests differ.
+    std::vector<std::string> changed;
+    /// The subset of the changed vertices which account for all of the other changes.
+    std::vector<std::string> root_causes;
+};
+
+/// Maps from vertex name to that vertex's hash digest.
+using digest_set = std::unordered_map<std::string, hash::digest>;
+
+/// Computes the digest of each of the vertices of a graph.
+digest_set graph_digests (std::vector<vertex const *> const & graph);
+
+/// Writes a digest_set to a stream in a form which can be read by read_digests().
+void write_digests (std::ostream & os, digest_set const & digests);
+/// Reads a digest_set which was written by write_digests().
+digest_set read_digests (std::istream & is);
+
+/// Compares two versions of a graph.
+///
+/// A vertex's digest changes if and only if some vertex reachable from it has a different name or
+/// ordered list of successors. This function therefore compares each vertex's immediate
+/// successors and then propagates changes to their predecessors; no hashing is required. The
+/// root causes are those vertices whose own successors differ.
+///
+/// \param old_graph  The vertices of the old version of the graph.
+/// \param new_graph  The vertices of the new version of the graph.
+/// \returns The differences between \p old_graph and \p new_graph.
+graph_diff diff_graphs (std::vector<vertex const *> const & old_graph,
+                        std::vector<vertex const *> const & new_graph);
+
+/// Compares a graph with the digests of an earlier version of it.
+///
+/// Vertices are hashed starting from those which have no predecessors. If a vertex's digest
+/// matches its old digest, then nothing reachable from it has changed and none of those vertices
+/// need be hashed; otherwise we descend to its successors. In the absence of the old graph's
+/// structure, the root causes are the members of each set of mutually reachable changed vertices
+/// from which no other changed vertex can be reached.
+///
+/// \param old_digests  The digests of the old version of the graph.
+/// \param new_graph  The vertices of the new version of the graph.
+/// \returns The differences between the two versions of the graph.
+graph_diff diff_digests (digest_set const & old_digests,
+                         std::vector<vertex const *> const & new_graph);
+
+#endif // DIFF_HPP
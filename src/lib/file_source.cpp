@@ -0,0 +1,116 @@
+#include "file_source.hpp"
+
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+file_source::file_source (std::string const & path, std::chrono::microseconds const latency,
+                          unsigned const workers)
+        : latency_{latency}
+        , workers_{workers}
+        , file_{path} {
+    if (workers == 0U) {
+        throw std::invalid_argument ("at least one worker is required");
+    }
+    if (!file_) {
+        throw std::runtime_error ("could not open \"" + path + '"');
+    }
+    // Build an index of the offset of each line in the file.
+    std::string line;
+    for (;;) {
+        auto const pos = static_cast<std::streamoff> (file_.tellg ());
+        if (!std::getline (file_, line)) {
+            break;
+        }
+        offsets_.push_back (pos);
+    }
+    file_.clear ();
+}
+
+std::shared_future<vertex_record> file_source::fetch (vertex_id const v) {
+    if (v >= offsets_.size ()) {
+        throw std::out_of_range ("vertex id " + std::to_string (v) + " is out of range");
+    }
+    std::shared_future<vertex_record> result;
+    {
+        std::lock_guard<std::mutex> const lock{queue_mut_};
+        if (threads_.empty ()) {
+            threads_.reserve (workers_);
+            for (auto ctr = 0U; ctr < workers_; ++ctr) {
+                threads_.emplace_back (&file_source::serve, this);
+            }
+        }
+        queue_.push_back (request{v, {}});
+        result = queue_.back ().promise.get_future ();
+    }
+    queue_cv_.notify_one ();
+    return result;
+}
+
+file_source::~file_source () noexcept {
+    {
+        std::lock_guard<std::mutex> const lock{queue_mut_};
+        stopping_ = true;
+    }
+    queue_cv_.notify_all ();
+    for (std::thread & t : threads_) {
+        t.join ();
+    }
+}
+
+void file_source::serve () {
+    for (;;) {
+        request r;
+        {
+            std::unique_lock<std::mutex> lock{queue_mut_};
+            queue_cv_.wait (lock, [this] () { return stopping_ || !queue_.empty (); });
+            // Requests which are still queued when the source is destroyed are served anyway so
+            // that no future is left without a value.
+            if (queue_.empty ()) {
+                return;
+            }
+            r = std::move (queue_.front ());
+            queue_.pop_front ();
+        }
+        try {
+            if (latency_.count () > 0) {
+                std::this_thread::sleep_for (latency_);
+            }
+            r.promise.set_value (this->read (r.v));
+        } catch (...) {
+            r.promise.set_exception (std::current_exception ());
+        }
+    }
+}
+
+vertex_record file_source::read (vertex_id const v) {
+    std::string line;
+    {
+        std::lock_guard<std::mutex> const lock{mut_};
+        file_.seekg (offsets_.at (v));
+        std::getline (file_, line);
+    }
+    return parse_vertex_record (line, v, offsets_.size ());
+}
+
+vertex_record parse_vertex_record (std::string const & line, vertex_id const v,
+                                   std::size_t const size) {
+    vertex_record result;
+    std::istringstream is{line};
+    if (!(is >> result.name)) {
+        throw std::runtime_error ("vertex " + std::to_string (v) + " has no name");
+    }
+    vertex_id out;
+    while (is >> out) {
+        if (out >= size) {
+            throw std::runtime_error ("vertex \"" + result.name +
+                                      "\" has an edge to an unknown vertex");
+        }
+        result.out_edges.push_back (out);
+    }
+    if (!is.eof ()) {
+        throw std::runtime_error ("bad edge list for vertex \"" + result.name + '"');
+    }
+    return result;
+}
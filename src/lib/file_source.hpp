@@ -0,0 +1,75 @@
+#ifndef FILE_SOURCE_HPP
+#define FILE_SOURCE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "graph_source.hpp"
+
+/// A graph_source backed by a text file. Each line of the file describes one vertex: its name
+/// followed by the zero or more ids of its successors, separated by whitespace. A vertex's id is
+/// the zero-based number of the line on which it appears.
+///
+/// Only an index of line offsets is kept in memory; records are read from the file on demand. An
+/// artificial latency may be added to each fetch to simulate slower storage. Fetches are queued
+/// and served by a fixed number of worker threads which are started by the first call to fetch().
+class file_source final : public graph_source {
+public:
+    static constexpr unsigned default_workers = 4U;
+
+    /// \param path  The path of the file containing the graph.
+    /// \param latency  A delay to be added to each fetch() request.
+    /// \param workers  The number of threads used to serve fetch() requests.
+    explicit file_source (std::string const & path, std::chrono::microseconds latency = {},
+                          unsigned workers = default_workers);
+    file_source (file_source const &) = delete;
+    file_source & operator= (file_source const &) = delete;
+    ~file_source () noexcept override;
+
+    /// Returns the number of vertices in the graph.
+    std::size_t size () const noexcept { return offsets_.size (); }
+
+    std::shared_future<vertex_record> fetch (vertex_id v) override;
+
+    /// Synchronously reads the record for vertex \p v.
+    vertex_record read (vertex_id v);
+
+private:
+    struct request {
+        vertex_id v = 0;
+        std::promise<vertex_record> promise;
+    };
+
+    /// The body of a worker thread: serves queued requests until the source is destroyed.
+    void serve ();
+
+    std::chrono::microseconds const latency_;
+    unsigned const workers_;
+    std::vector<std::streamoff> offsets_;
+
+    std::mutex mut_;
+    std::ifstream file_;
+
+    std::mutex queue_mut_;
+    std::condition_variable queue_cv_;
+    std::deque<request> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
+
+/// Parses one line of a graph file in the format read by file_source.
+///
+/// \param line  The text of the line.
+/// \param v  The id of the vertex described by the line.
+/// \param size  The number of vertices in the graph. Edges to other vertices are rejected.
+/// \returns The record for vertex \p v.
+vertex_record parse_vertex_record (std::string const & line, vertex_id v, std::size_t size);
+
+#endif // FILE_SOURCE_HPP
@@ -0,0 +1,7 @@
+#include "graph_source.hpp"
+
+graph_source::~graph_source () noexcept = default;
+
+std::optional<hash::digest> graph_source::known_digest (vertex_id) {
+    return std::nullopt;
+}
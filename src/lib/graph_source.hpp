@@ -0,0 +1,47 @@
+#ifndef GRAPH_SOURCE_HPP
+#define GRAPH_SOURCE_HPP
+
+#include <cstddef>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "hash.hpp"
+
+/// Identifies a vertex within a graph_source.
+using vertex_id = std::size_t;
+
+/// The name and out-going edges of a single vertex as supplied by a graph_source.
+struct vertex_record {
+    std::string name;
+    std::vector<vertex_id> out_edges;
+};
+
+/// An abstract source of graph vertices. Unlike class vertex, whose out-edges are always resident
+/// in memory, a graph_source may be backed by slow storage and so delivers each vertex's record
+/// asynchronously.
+class graph_source {
+public:
+    virtual ~graph_source () noexcept;
+
+    /// Begins fetching the record for vertex \p v. The caller may issue many requests before
+    /// waiting on any of them.
+    ///
+    /// \param v  The vertex whose record is to be fetched.
+    /// \returns A future which will yield the record for vertex \p v.
+    virtual std::shared_future<vertex_record> fetch (vertex_id v) = 0;
+
+    /// Returns the digest of vertex \p v if it is already known from elsewhere, allowing the
+    /// vertex and everything reachable from it to be skipped. A digest may only be supplied if
+    /// the vertex cannot reach any of the vertices on the path by which it was reached since only
+    /// then is the digest independent of that path. This always holds for a vertex which
+    /// vertex_hash() would memoize. Known digests are not memoized by lazy_vertex_hash(), so this
+    /// function may be called many times for the same vertex.
+    ///
+    /// \param v  The vertex whose digest is wanted.
+    /// \returns The digest of vertex \p v or nothing if it is not known.
+    virtual std::optional<hash::digest> known_digest (vertex_id v);
+};
+
+#endif // GRAPH_SOURCE_HPP
@@ -7,6 +7,7 @@ namespace {
 
     enum class tags : char {
         backref = 'R',
+        bound = 'B',
         digest = 'D',
         end = 'E',
         vertex = 'V',
@@ -19,9 +20,11 @@ size_t hash::bytes_ = 0;
 #ifdef FNV1_HASH_ENABLED
 
 void hash::update_vertex (vertex const & x) noexcept {
+    this->update_vertex (x.name ());
+}
+void hash::update_vertex (std::string const & name) noexcept {
     static constexpr auto tag = tags::vertex;
     update (&tag, sizeof (tag));
-    auto const & name = x.name ();
     update (name.c_str (), name.length () + 1U);
 }
 void hash::update_backref (size_t const backref) noexcept {
@@ -29,6 +32,11 @@ void hash::update_backref (size_t const backref) noexcept {
     update (&tag, sizeof (tag));
     update (&backref, sizeof (backref));
 }
+void hash::update_bound (size_t const horizon) noexcept {
+    static constexpr auto tag = tags::bound;
+    update (&tag, sizeof (tag));
+    update (&horizon, sizeof (horizon));
+}
 void hash::update_digest (digest const & d) noexcept {
     static constexpr auto tag = tags::digest;
     update (&tag, sizeof (tag));
@@ -56,7 +64,10 @@ std::string hash::prefix () const {
 }
 
 void hash::update_vertex (vertex const & x) {
-    auto const add = prefix () + static_cast<char> (tags::vertex) + x.name ();
+    this->update_vertex (x.name ());
+}
+void hash::update_vertex (std::string const & name) {
+    auto const add = prefix () + static_cast<char> (tags::vertex) + name;
     bytes_ += add.length ();
     state_ += add;
 }
@@ -65,6 +76,11 @@ void hash::update_backref (size_t const backref) {
     bytes_ += add.length ();
     state_ += add;
 }
+void hash::update_bound (size_t const horizon) {
+    auto const add = prefix () + static_cast<char> (tags::bound) + std::to_string (horizon);
+    bytes_ += add.length ();
+    state_ += add;
+}
 void hash::update_digest (digest const & d) {
     auto const add = prefix () /*+ static_cast<char> (tags::digest)*/ + d;
     bytes_ += add.length ();
@@ -23,7 +23,9 @@ public:
     digest finalize () const noexcept { return state_; }
 
     void update_vertex (vertex const & x) noexcept;
+    void update_vertex (std::string const & name) noexcept;
     void update_backref (size_t backref) noexcept;
+    void update_bound (size_t horizon) noexcept;
     void update_digest (digest const & d) noexcept;
     void update_end () noexcept;
 
@@ -47,7 +49,9 @@ public:
     digest finalize () const noexcept { return state_; }
 
     void update_vertex (vertex const & x);
+    void update_vertex (std::string const & name);
     void update_backref (size_t backref);
+    void update_bound (size_t horizon);
     void update_digest (digest const & d);
     void update_end ();
 
@@ -0,0 +1,140 @@
+#include "lazy_hash.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "trace.hpp"
+
+namespace {
+
+    struct context {
+        explicit context (graph_source & s, lazy_memoized_hashes * const t)
+                : source{s}
+                , table{t} {}
+
+        graph_source & source;
+        lazy_memoized_hashes * const table;
+        /// Records the depth of each vertex on the current path.
+        std::unordered_map<vertex_id, std::size_t> visited;
+        /// Records which have been requested from the source but not yet consumed.
+        std::unordered_map<vertex_id, std::shared_future<vertex_record>> pending;
+    };
+
+    enum lvhi_result_indices { depth_index, digest_index };
+
+    /// Returns the record for vertex \p v, waiting for a previously issued prefetch if there was
+    /// one.
+    vertex_record get_record (context * const c, vertex_id const v) {
+        auto const pos = c->pending.find (v);
+        if (pos != c->pending.end ()) {
+            return pos->second.get ();
+        }
+        return c->source.fetch (v).get ();
+    }
+
+    /// Requests the records of the successors of \p record, starting at index \p *next, which
+    /// we're likely to need. Stops when the prefetch window is full. One place in the window is
+    /// always left free for the fetch issued by get_record() for a successor which could not be
+    /// prefetched.
+    ///
+    /// \param next  The index of the first successor not yet considered. Updated on return.
+    /// \param started  The ids of the vertices whose fetch was started by this frame.
+    void prefetch (context * const c, vertex_record const & record, std::size_t * const next,
+                   std::unordered_set<vertex_id> * const started) {
+        auto const & out_edges = record.out_edges;
+        for (; *next < out_edges.size () && c->pending.size () + 1U < lazy_prefetch_window;
+             ++*next) {
+            vertex_id const out = out_edges[*next];
+            // No record is needed for vertices whose digest is already known or which will be
+            // encoded as a back-reference.
+            if (c->table->find (out) == c->table->end () &&
+                c->visited.find (out) == c->visited.end () &&
+                c->pending.find (out) == c->pending.end ()) {
+                c->pending.emplace (out, c->source.fetch (out));
+                started->insert (out);
+            }
+        }
+    }
+
+    auto lazy_vertex_hash_impl (context * const c, vertex_id const v)
+        -> std::tuple<std::size_t, hash::digest> {
+        auto const depth = c->visited.size ();
+        trace ("Computing hash for vertex #", v, " (#", depth, ')');
+
+        auto const table_pos = c->table->find (v);
+        if (table_pos != c->table->end ()) {
+            trace ("Returning pre-computed hash for vertex #", v);
+            return std::make_tuple (depth, table_pos->second);
+        }
+
+        hash h;
+
+        auto const [visited_pos, inserted] = c->visited.try_emplace (v, depth);
+        if (inserted) {
+            // Does the source already know the digest of this vertex?
+            if (std::optional<hash::digest> const known = c->source.known_digest (v)) {
+                // The digest is not added to the table: the source is responsible for caching it.
+                trace ("Returning known hash for vertex #", v);
+                c->visited.erase (visited_pos);
+                return std::make_tuple (depth, *known);
+            }
+        } else {
+            assert (depth > visited_pos->second);
+            h.update_backref (depth - visited_pos->second - 1U);
+            trace ("Returning back-ref to #", visited_pos->second);
+            return std::make_tuple (visited_pos->second, h.finalize ());
+        }
+
+        vertex_record const record = get_record (c, v);
+        std::unordered_set<vertex_id> started;
+        auto next = std::size_t{0};
+        prefetch (c, record, &next, &started);
+
+        h.update_vertex (record.name);
+
+        auto loop_point = std::numeric_limits<std::size_t>::max ();
+        for (vertex_id const out : record.out_edges) {
+            auto const adj_digest = lazy_vertex_hash_impl (c, out);
+            if (out != v) {
+                loop_point = std::min (loop_point, std::get<depth_index> (adj_digest));
+            }
+            h.update_digest (std::get<digest_index> (adj_digest));
+
+            // This successor's record has been consumed: release it and slide the window along
+            // the remaining successors.
+            if (started.erase (out) > 0U) {
+                c->pending.erase (out);
+            }
+            prefetch (c, record, &next, &started);
+        }
+        h.update_end ();
+
+        for (vertex_id const s : started) {
+            c->pending.erase (s);
+        }
+
+        auto const result = std::make_tuple (loop_point, h.finalize ());
+        if (loop_point > depth) {
+            trace ("Recording result for vertex #", v);
+            (*c->table)[v] = std::get<digest_index> (result);
+        }
+        c->visited.erase (v);
+        return result;
+    }
+
+} // end anonymous namespace
+
+hash::digest lazy_vertex_hash (graph_source & source, vertex_id const v,
+                               lazy_memoized_hashes * const table) {
+    context c{source, table};
+    auto const result = std::get<digest_index> (lazy_vertex_hash_impl (&c, v));
+    assert (c.visited.empty ());
+    assert (c.pending.empty ());
+    return result;
+}
@@ -0,0 +1,34 @@
+#ifndef LAZY_HASH_HPP
+#define LAZY_HASH_HPP
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "graph_source.hpp"
+#include "hash.hpp"
+
+using lazy_memoized_hashes = std::unordered_map<vertex_id, hash::digest>;
+
+/// The maximum number of records which lazy_vertex_hash() may have requested from its source but
+/// not yet consumed.
+constexpr std::size_t lazy_prefetch_window = 64U;
+
+/// Computes the hash digest of an individual vertex from a graph_source. The result is identical
+/// to that produced by vertex_hash() for the equivalent in-memory graph.
+///
+/// When a vertex is entered, the records of its successors are requested from the source before
+/// any of them is hashed. Retrieval of those records therefore overlaps with the hashing of their
+/// earlier siblings. The number of records which have been requested but not yet consumed is
+/// limited to lazy_prefetch_window, shared by all of the frames of the traversal stack; each record
+/// is released once its vertex has been hashed and the window then moves on to the next successor.
+/// Digests which the source already knows (see graph_source::known_digest()) are used as they
+/// are and are not added to \p table.
+///
+/// \param source  The source of the graph's vertices.
+/// \param v  The vertex whose hash digest is to be computed.
+/// \param table  Used to record memoized hashes. Pass the same object to multiple calls to this
+///    function to improve performance.
+/// \returns The hash digest for vertex \p v.
+hash::digest lazy_vertex_hash (graph_source & source, vertex_id v, lazy_memoized_hashes * table);
+
+#endif // LAZY_HASH_HPP
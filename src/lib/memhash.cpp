@@ -6,7 +6,10 @@
 #include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "profile.hpp"
+#include "sharing_points.hpp"
 #include "trace.hpp"
 #include "vertex.hpp"
 
@@ -17,7 +20,9 @@ namespace {
     enum vhi_result_indices { depth_index, digest_index };
 
     auto vertex_hash_impl (vertex const * const v, memoized_hashes * const table,
-                           visited * const visited) -> std::tuple<std::size_t, hash::digest> {
+                           visited * const visited, hash_profile * const profile,
+                           sharing_points * const sparse)
+        -> std::tuple<std::size_t, hash::digest> {
         auto const depth = visited->size ();
         trace ("Computing hash for ", *v, " (#", depth, ')');
 
@@ -26,9 +31,13 @@ namespace {
         auto const table_pos = table->find (v);
         if (table_pos != table->end ()) {
             trace ("Returning pre-computed hash for ", *v);
+            if (profile != nullptr) {
+                profile->record_memo_hit (v);
+            }
             return std::make_tuple (depth, table_pos->second);
         }
 
+        auto const start_bytes = hash::total ();
         hash h;
 
         // Have we previously visited this vertex on this path? If so, add to the hash a
@@ -42,6 +51,9 @@ namespace {
             assert (depth > visited_pos->second);
             h.update_backref (depth - visited_pos->second - 1U);
             trace ("Returning back-ref to #", visited_pos->second);
+            if (profile != nullptr) {
+                profile->record_backref (v, hash::total () - start_bytes);
+            }
             return std::make_tuple (visited_pos->second, h.finalize ());
         }
 
@@ -50,24 +62,56 @@ namespace {
 
         // Enumerate the adjacent vertices.
         auto loop_point = std::numeric_limits<std::size_t>::max ();
+        auto successor_bytes = std::size_t{0};
+        // In memo-sparse mode, the memoizable successors whose digests were not stored.
+        std::vector<std::pair<vertex const *, hash::digest>> deferred;
         for (vertex const * const out : v->out_edges ()) {
             // Add  any properties of the edge from 'v' to 'out' to the hash here.
 
             // Encode the out-going vertex.
-            auto const adj_digest = vertex_hash_impl (out, table, visited);
+            auto const before = hash::total ();
+            auto const adj_digest = vertex_hash_impl (out, table, visited, profile, sparse);
+            successor_bytes += hash::total () - before;
             // A out-edge that points back to this same vertex doesn't count as a loop.
             if (out != v) {
                 loop_point = std::min (loop_point, std::get<depth_index> (adj_digest));
             }
+            // A successor whose loop point lies beyond it was memoizable. (One whose digest came
+            // from the table reports its own depth.)
+            if (sparse != nullptr && std::get<depth_index> (adj_digest) > depth + 1U &&
+                !sparse->contains (out)) {
+                deferred.emplace_back (out, std::get<digest_index> (adj_digest));
+            }
             h.update_digest (std::get<digest_index> (adj_digest));
         }
         // We've encoded the final edge. Record that in the hash.
         h.update_end ();
 
         auto const result = std::make_tuple (loop_point, h.finalize ());
-        if (loop_point > depth) {
+        bool const memoizable = loop_point > depth;
+        // In memo-sparse mode, a vertex which isn't a sharing point is reached only through its
+        // parent. Whether it needs to be stored depends on the parent, which decides below.
+        bool const memoized =
+            memoizable && (sparse == nullptr || depth == 0U || sparse->contains (v));
+        if (memoized) {
             trace ("Recording result for ", *v);
             (*table)[v] = std::get<digest_index> (result);
+            if (sparse != nullptr) {
+                sparse->record (true);
+            }
+        }
+        // If this vertex is memoizable, it will never be hashed again, so neither will its
+        // deferred successors. If not, it lies on a loop which may be walked again: store them so
+        // that their subgraphs aren't.
+        for (auto const & [out, digest] : deferred) {
+            if (!memoizable) {
+                trace ("Recording result for ", *out);
+                (*table)[out] = digest;
+            }
+            sparse->record (!memoizable);
+        }
+        if (profile != nullptr) {
+            profile->record_visit (v, hash::total () - start_bytes - successor_bytes, memoizable);
         }
         visited->erase (v);
         return result;
@@ -75,9 +119,11 @@ namespace {
 
 } // end anonymous namespace
 
-hash::digest vertex_hash (vertex const * const v, memoized_hashes * const table) {
+hash::digest vertex_hash (vertex const * const v, memoized_hashes * const table,
+                          hash_profile * const profile, sharing_points * const sparse) {
     visited visited;
-    auto const result = std::get<digest_index> (vertex_hash_impl (v, table, &visited));
+    auto const result =
+        std::get<digest_index> (vertex_hash_impl (v, table, &visited, profile, sparse));
     assert (visited.empty ());
     return result;
 }
@@ -6,6 +6,8 @@
 
 #include "hash.hpp"
 
+class hash_profile;
+class sharing_points;
 class vertex;
 using memoized_hashes = std::unordered_map<vertex const *, hash::digest>;
 
@@ -15,7 +17,12 @@ using memoized_hashes = std::unordered_map<vertex const *, hash::digest>;
 /// \param v  The vertex whose hash digest is to be computed.
 /// \param table  Used to record memoized hashes. Pass the same object to multiple calls to this
 ///    function to improve performance.
+/// \param profile  If not null, records the cost attributable to each vertex that is visited.
+/// \param sparse  If not null, enables memo-sparse mode: see sharing_points. The object records
+///    the number of digests which were stored and skipped.
 /// \returns The hash digest for vertex \p v.
-hash::digest vertex_hash (vertex const * const v, memoized_hashes * const table);
+hash::digest vertex_hash (vertex const * const v, memoized_hashes * const table,
+                          hash_profile * const profile = nullptr,
+                          sharing_points * const sparse = nullptr);
 
 #endif // MEMHASH_HPP
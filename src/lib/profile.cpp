@@ -0,0 +1,227 @@
+#include "profile.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "scc.hpp"
+#include "vertex.hpp"
+
+namespace {
+
+    /// A strongly connected component whose members could not be memoized.
+    struct region {
+        std::vector<vertex const *> members;
+        std::size_t visits = 0;
+        std::size_t bytes = 0;
+    };
+
+    bool by_name (vertex const * const a, vertex const * const b) {
+        return a->name () < b->name ();
+    }
+
+    /// Returns the SCCs which contain vertices that could not be memoized, sorted by decreasing
+    /// cost.
+    std::vector<region> find_regions (hash_profile::container const & vertices) {
+        std::vector<vertex const *> members;
+        members.reserve (vertices.size ());
+        for (auto const & vp : vertices) {
+            members.push_back (vp.first);
+        }
+
+        std::vector<region> result;
+        for (auto const & component : strongly_connected_components (members)) {
+            // A vertex which is not on a cycle can always be memoized.
+            if (component.size () < 2U) {
+                continue;
+            }
+            region r;
+            r.members = component;
+            std::sort (std::begin (r.members), std::end (r.members), by_name);
+            for (vertex const * const v : r.members) {
+                vertex_profile const & p = vertices.at (v);
+                r.visits += p.visits;
+                r.bytes += p.bytes;
+            }
+            result.push_back (std::move (r));
+        }
+        std::sort (std::begin (result), std::end (result), [] (region const & a, region const & b) {
+            if (a.bytes != b.bytes) {
+                return a.bytes > b.bytes;
+            }
+            return by_name (a.members.front (), b.members.front ());
+        });
+        return result;
+    }
+
+    /// Maps each vertex which belongs to a region to the (one-based) number of that region.
+    std::unordered_map<vertex const *, std::size_t> region_numbers (std::vector<region> const & r) {
+        std::unordered_map<vertex const *, std::size_t> result;
+        for (auto index = std::size_t{0}; index < r.size (); ++index) {
+            for (vertex const * const v : r[index].members) {
+                result[v] = index + 1U;
+            }
+        }
+        return result;
+    }
+
+    /// Escapes the characters of \p s which are special within a DOT quoted string.
+    std::string escaped (std::string const & s) {
+        std::string result;
+        for (char const c : s) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result;
+    }
+
+} // end anonymous namespace
+
+void hash_profile::record_visit (vertex const * const v, std::size_t const bytes,
+                                 bool const memoized) {
+    vertex_profile & p = vertices_[v];
+    ++p.visits;
+    p.bytes += bytes;
+    p.memoized = p.memoized || memoized;
+}
+
+void hash_profile::record_memo_hit (vertex const * const v) {
+    ++vertices_[v].memo_hits;
+}
+
+void hash_profile::record_backref (vertex const * const v, std::size_t const bytes) {
+    vertex_profile & p = vertices_[v];
+    ++p.backrefs;
+    p.bytes += bytes;
+}
+
+void hash_profile::report (std::ostream & os) const {
+    auto const flags = os.flags ();
+    using value_type = container::value_type;
+    std::vector<value_type const *> order;
+    order.reserve (vertices_.size ());
+    std::size_t name_width = 6;
+    std::size_t total_visits = 0;
+    std::size_t total_bytes = 0;
+    for (value_type const & vp : vertices_) {
+        order.push_back (&vp);
+        name_width = std::max (name_width, vp.first->name ().length ());
+        total_visits += vp.second.visits;
+        total_bytes += vp.second.bytes;
+    }
+    std::sort (std::begin (order), std::end (order),
+               [] (value_type const * const a, value_type const * const b) {
+                   if (a->second.bytes != b->second.bytes) {
+                       return a->second.bytes > b->second.bytes;
+                   }
+                   if (a->second.visits != b->second.visits) {
+                       return a->second.visits > b->second.visits;
+                   }
+                   return by_name (a->first, b->first);
+               });
+
+    auto const regions = find_regions (vertices_);
+    auto const numbers = region_numbers (regions);
+
+    os << "Vertices: " << vertices_.size () << ", visits: " << total_visits
+       << ", bytes hashed: " << total_bytes << "\n\n";
+
+    auto const w = static_cast<int> (name_width);
+    os << std::left << std::setw (w) << "vertex" << std::right << std::setw (11) << "visits"
+       << std::setw (11) << "memo-hits" << std::setw (11) << "back-refs" << std::setw (12)
+       << "bytes" << "  scc\n";
+    for (value_type const * const vp : order) {
+        vertex_profile const & p = vp->second;
+        os << std::left << std::setw (w) << vp->first->name () << std::right << std::setw (11)
+           << p.visits << std::setw (11) << p.memo_hits << std::setw (11) << p.backrefs
+           << std::setw (12) << p.bytes << "  ";
+        auto const pos = numbers.find (vp->first);
+        if (pos != numbers.end ()) {
+            os << '#' << pos->second;
+        } else {
+            os << '-';
+        }
+        os << '\n';
+    }
+
+    if (!regions.empty ()) {
+        os << "\nNon-memoizable regions (strongly connected components):\n";
+        os << std::left << std::setw (6) << "scc" << std::right << std::setw (11) << "vertices"
+           << std::setw (11) << "visits" << std::setw (12) << "bytes" << "  members\n";
+        for (auto index = std::size_t{0}; index < regions.size (); ++index) {
+            region const & r = regions[index];
+            os << std::left << std::setw (6) << ('#' + std::to_string (index + 1U)) << std::right
+               << std::setw (11) << r.members.size () << std::setw (11) << r.visits
+               << std::setw (12) << r.bytes << ' ';
+            for (vertex const * const v : r.members) {
+                os << ' ' << v->name ();
+            }
+            os << '\n';
+        }
+    }
+    os.flags (flags);
+}
+
+void hash_profile::write_dot (std::ostream & os) const {
+    auto const flags = os.flags ();
+    auto const precision = os.precision ();
+    // Give each vertex a stable identifier in name order.
+    std::vector<vertex const *> order;
+    order.reserve (vertices_.size ());
+    std::size_t max_bytes = 1;
+    for (auto const & vp : vertices_) {
+        order.push_back (vp.first);
+        max_bytes = std::max (max_bytes, vp.second.bytes);
+    }
+    std::sort (std::begin (order), std::end (order), by_name);
+    std::unordered_map<vertex const *, std::size_t> ids;
+    for (auto index = std::size_t{0}; index < order.size (); ++index) {
+        ids[order[index]] = index;
+    }
+
+    auto const write_vertex = [&] (vertex const * const v, char const * const indent) {
+        vertex_profile const & p = vertices_.at (v);
+        // Shade from white (cold) to red (hot).
+        auto const heat = static_cast<double> (p.bytes) / static_cast<double> (max_bytes);
+        os << indent << 'v' << ids.at (v) << " [label=\"" << escaped (v->name ()) << "\\n"
+           << p.visits << " visits\\n" << p.bytes << " bytes\", style=filled, fillcolor=\"0.000 "
+           << std::fixed << std::setprecision (3) << heat << " 1.000\"];\n";
+    };
+
+    os << "digraph G {\n";
+    os << "    rankdir = LR;\n";
+    os << "    graph [bgcolor=transparent];\n";
+    os << "    node [shape=box];\n";
+
+    auto const regions = find_regions (vertices_);
+    auto const numbers = region_numbers (regions);
+    for (auto index = std::size_t{0}; index < regions.size (); ++index) {
+        os << "    subgraph cluster_" << index + 1U << " {\n";
+        os << "        label = \"scc #" << index + 1U << "\";\n";
+        os << "        style = dashed;\n";
+        for (vertex const * const v : regions[index].members) {
+            write_vertex (v, "        ");
+        }
+        os << "    }\n";
+    }
+    for (vertex const * const v : order) {
+        if (numbers.find (v) == numbers.end ()) {
+            write_vertex (v, "    ");
+        }
+    }
+    for (vertex const * const v : order) {
+        for (vertex const * const out : v->out_edges ()) {
+            auto const pos = ids.find (out);
+            if (pos != ids.end ()) {
+                os << "    v" << ids.at (v) << " -> v" << pos->second << ";\n";
+            }
+        }
+    }
+    os << "}\n";
+    os.flags (flags);
+    os.precision (precision);
+}
@@ -0,0 +1,51 @@
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <unordered_map>
+
+class vertex;
+
+/// The cost attributed to a single vertex while computing hashes.
+struct vertex_profile {
+    /// The number of times that the vertex was encoded in full.
+    std::size_t visits = 0;
+    /// The number of times that the vertex's memoized digest was used.
+    std::size_t memo_hits = 0;
+    /// The number of times that the vertex was encoded as a back-reference.
+    std::size_t backrefs = 0;
+    /// The number of bytes passed to the hash function by the vertex's own encodings (excluding
+    /// those of its successors).
+    std::size_t bytes = 0;
+    /// True if the vertex's digest was memoized.
+    bool memoized = false;
+};
+
+/// Collects the cost of each vertex visited by vertex_hash(). Every full visit to a vertex beyond
+/// the first is wasted work which is caused by a loop preventing memoization. The report groups
+/// such vertices by the strongly connected component (SCC) to which they belong so that the loops
+/// responsible are easy to identify.
+class hash_profile {
+public:
+    using container = std::unordered_map<vertex const *, vertex_profile>;
+
+    void record_visit (vertex const * v, std::size_t bytes, bool memoized);
+    void record_memo_hit (vertex const * v);
+    void record_backref (vertex const * v, std::size_t bytes);
+
+    container const & vertices () const noexcept { return vertices_; }
+
+    /// Writes a report listing the vertices and non-memoizable SCCs in decreasing order of the
+    /// number of bytes hashed.
+    void report (std::ostream & os) const;
+
+    /// Writes a GraphViz DOT graph of the profiled vertices. Each vertex is shaded according to
+    /// the number of bytes hashed on its behalf; non-memoizable SCCs are drawn as clusters.
+    void write_dot (std::ostream & os) const;
+
+private:
+    container vertices_;
+};
+
+#endif // PROFILE_HPP
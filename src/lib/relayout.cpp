@@ -0,0 +1,213 @@
+#include "relayout.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+    /// A graph's adjacency lists in compressed sparse row form, using dense vertex indices.
+    class adjacency {
+    public:
+        explicit adjacency (std::size_t const size)
+                : offsets_ (size + 1U, 0U) {}
+
+        std::size_t size () const noexcept { return offsets_.size () - 1U; }
+        std::size_t const * begin (std::size_t const v) const noexcept {
+            return targets_.data () + offsets_[v];
+        }
+        std::size_t const * end (std::size_t const v) const noexcept {
+            return targets_.data () + offsets_[v + 1U];
+        }
+        std::size_t degree (std::size_t const v) const noexcept {
+            return offsets_[v + 1U] - offsets_[v];
+        }
+
+        /// Builds the graph's out-edges.
+        static adjacency successors (std::vector<vertex const *> const & graph,
+                                     std::unordered_map<vertex const *, std::size_t> const & index);
+        /// Builds the graph's edges with their directions ignored.
+        static adjacency undirected (adjacency const & successors);
+
+    private:
+        std::vector<std::size_t> offsets_;
+        std::vector<std::size_t> targets_;
+    };
+
+    adjacency
+    adjacency::successors (std::vector<vertex const *> const & graph,
+                           std::unordered_map<vertex const *, std::size_t> const & index) {
+        adjacency result{graph.size ()};
+        for (auto v = std::size_t{0}; v < graph.size (); ++v) {
+            auto const & out = graph[v]->out_edges ();
+            result.offsets_[v + 1U] = result.offsets_[v] + out.size ();
+            for (vertex const * const w : out) {
+                auto const pos = index.find (w);
+                if (pos == index.end ()) {
+                    throw std::invalid_argument ("vertex \"" + graph[v]->name () +
+                                                 "\" has an edge to a vertex outside the graph");
+                }
+                result.targets_.push_back (pos->second);
+            }
+        }
+        return result;
+    }
+
+    adjacency adjacency::undirected (adjacency const & successors) {
+        auto const size = successors.size ();
+        adjacency result{size};
+        // Count the degree of each vertex then fill in the edges.
+        for (auto v = std::size_t{0}; v < size; ++v) {
+            result.offsets_[v + 1U] += successors.degree (v);
+            std::for_each (successors.begin (v), successors.end (v),
+                           [&result] (std::size_t const w) { ++result.offsets_[w + 1U]; });
+        }
+        std::partial_sum (std::begin (result.offsets_), std::end (result.offsets_),
+                          std::begin (result.offsets_));
+        result.targets_.resize (result.offsets_.back ());
+        std::vector<std::size_t> fill (std::begin (result.offsets_),
+                                       std::prev (std::end (result.offsets_)));
+        for (auto v = std::size_t{0}; v < size; ++v) {
+            std::for_each (successors.begin (v), successors.end (v), [&] (std::size_t const w) {
+                result.targets_[fill[v]++] = w;
+                result.targets_[fill[w]++] = v;
+            });
+        }
+        return result;
+    }
+
+
+    /// Returns the vertices in depth-first pre-order, visiting successors in edge order.
+    std::vector<std::size_t> depth_first (adjacency const & g) {
+        std::vector<std::size_t> result;
+        result.reserve (g.size ());
+        std::vector<bool> visited (g.size (), false);
+        // Each stack entry is a vertex and the position of the next edge to be followed.
+        std::vector<std::pair<std::size_t, std::size_t const *>> stack;
+        for (auto root = std::size_t{0}; root < g.size (); ++root) {
+            if (visited[root]) {
+                continue;
+            }
+            visited[root] = true;
+            result.push_back (root);
+            stack.emplace_back (root, g.begin (root));
+            while (!stack.empty ()) {
+                auto & top = stack.back ();
+                if (top.second == g.end (top.first)) {
+                    stack.pop_back ();
+                    continue;
+                }
+                std::size_t const w = *(top.second++);
+                if (!visited[w]) {
+                    visited[w] = true;
+                    result.push_back (w);
+                    stack.emplace_back (w, g.begin (w));
+                }
+            }
+        }
+        return result;
+    }
+
+    /// Returns the vertices in breadth-first order starting from each unvisited vertex in turn.
+    /// \p next may be used to control the order in which each vertex's neighbors are visited.
+    template <typename NeighborsFunction>
+    std::vector<std::size_t> breadth_first (adjacency const & g,
+                                            std::vector<std::size_t> const & roots,
+                                            NeighborsFunction next) {
+        std::vector<std::size_t> result;
+        result.reserve (g.size ());
+        std::vector<bool> visited (g.size (), false);
+        std::deque<std::size_t> queue;
+        for (std::size_t const root : roots) {
+            if (visited[root]) {
+                continue;
+            }
+            visited[root] = true;
+            queue.push_back (root);
+            while (!queue.empty ()) {
+                std::size_t const v = queue.front ();
+                queue.pop_front ();
+                result.push_back (v);
+                next (v, [&] (std::size_t const w) {
+                    if (!visited[w]) {
+                        visited[w] = true;
+                        queue.push_back (w);
+                    }
+                });
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::size_t> breadth_first (adjacency const & g) {
+        std::vector<std::size_t> roots (g.size ());
+        std::iota (std::begin (roots), std::end (roots), std::size_t{0});
+        return breadth_first (g, roots, [&g] (std::size_t const v, auto visit) {
+            std::for_each (g.begin (v), g.end (v), visit);
+        });
+    }
+
+    /// Returns the vertices in reverse Cuthill-McKee order: each component is traversed
+    /// breadth-first from a vertex of minimum degree, visiting neighbors in order of increasing
+    /// degree, and the resulting order is reversed.
+    std::vector<std::size_t> reverse_cuthill_mckee (adjacency const & successors) {
+        adjacency const g = adjacency::undirected (successors);
+        auto const by_degree = [&g] (std::size_t const a, std::size_t const b) {
+            return g.degree (a) < g.degree (b);
+        };
+
+        std::vector<std::size_t> roots (g.size ());
+        std::iota (std::begin (roots), std::end (roots), std::size_t{0});
+        std::stable_sort (std::begin (roots), std::end (roots), by_degree);
+
+        std::vector<std::size_t> neighbors;
+        auto result = breadth_first (g, roots, [&] (std::size_t const v, auto visit) {
+            neighbors.assign (g.begin (v), g.end (v));
+            std::stable_sort (std::begin (neighbors), std::end (neighbors), by_degree);
+            std::for_each (std::begin (neighbors), std::end (neighbors), visit);
+        });
+        std::reverse (std::begin (result), std::end (result));
+        return result;
+    }
+
+} // end anonymous namespace
+
+relaid_graph::relaid_graph (std::vector<vertex const *> const & graph, layout_order const order) {
+    index_.reserve (graph.size ());
+    for (auto v = std::size_t{0}; v < graph.size (); ++v) {
+        index_.emplace (graph[v], v);
+    }
+    if (index_.size () != graph.size ()) {
+        throw std::invalid_argument ("a vertex appears more than once in the graph");
+    }
+    adjacency const successors = adjacency::successors (graph, index_);
+
+    std::vector<std::size_t> layout;
+    switch (order) {
+    case layout_order::depth_first: layout = depth_first (successors); break;
+    case layout_order::breadth_first: layout = breadth_first (successors); break;
+    case layout_order::reverse_cuthill_mckee: layout = reverse_cuthill_mckee (successors); break;
+    }
+
+    position_.resize (graph.size ());
+    for (auto p = std::size_t{0}; p < layout.size (); ++p) {
+        position_[layout[p]] = p;
+    }
+
+    // The vertices refer to one another by address so the storage must not be reallocated once
+    // construction begins.
+    vertices_.reserve (graph.size ());
+    originals_.reserve (graph.size ());
+    vertex const * const base = vertices_.data ();
+    for (std::size_t const v : layout) {
+        std::vector<vertex const *> out;
+        out.reserve (successors.degree (v));
+        std::transform (successors.begin (v), successors.end (v), std::back_inserter (out),
+                        [&] (std::size_t const w) { return base + position_[w]; });
+        vertices_.emplace_back (graph[v]->name (), std::move (out));
+        originals_.push_back (graph[v]);
+    }
+}
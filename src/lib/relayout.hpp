@@ -0,0 +1,56 @@
+#ifndef RELAYOUT_HPP
+#define RELAYOUT_HPP
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "vertex.hpp"
+
+/// The orders in which a relaid_graph may arrange its vertices.
+enum class layout_order {
+    /// Depth-first pre-order: the order in which vertex_hash() first reaches each vertex.
+    depth_first,
+    /// Breadth-first order.
+    breadth_first,
+    /// Reverse Cuthill-McKee order (of the graph with edge directions ignored), which tends to
+    /// place the endpoints of each edge close together.
+    reverse_cuthill_mckee,
+};
+
+/// A copy of a graph whose vertices are stored contiguously in an order chosen to make traversal
+/// walk memory mostly sequentially. Graphs built by adding vertices to a std::list<> are
+/// scattered across the heap in creation order; hashing the copy instead avoids taking a cache
+/// miss on almost every edge.
+class relaid_graph {
+public:
+    /// \param graph  The vertices of the graph to be copied. The graph must be closed: the
+    ///   successors of each vertex must also appear in this collection.
+    /// \param order  The order in which the vertices are to be laid out.
+    relaid_graph (std::vector<vertex const *> const & graph, layout_order order);
+    relaid_graph (relaid_graph const &) = delete;
+    relaid_graph & operator= (relaid_graph const &) = delete;
+
+    /// The copied vertices, in layout order.
+    std::vector<vertex> const & vertices () const noexcept { return vertices_; }
+
+    /// Maps from a vertex of the original graph to its copy.
+    vertex const * relaid (vertex const * original) const {
+        return &vertices_[position_[index_.at (original)]];
+    }
+    /// Maps from a copied vertex back to the vertex of the original graph.
+    vertex const * original (vertex const * relaid) const {
+        return originals_.at (static_cast<std::size_t> (relaid - vertices_.data ()));
+    }
+
+private:
+    std::vector<vertex> vertices_;
+    /// The original vertex corresponding to each member of vertices_.
+    std::vector<vertex const *> originals_;
+    /// Maps from an original vertex to its index in the original graph.
+    std::unordered_map<vertex const *, std::size_t> index_;
+    /// The index in vertices_ of the copy of each vertex of the original graph.
+    std::vector<std::size_t> position_;
+};
+
+#endif // RELAYOUT_HPP
@@ -0,0 +1,83 @@
+#include "scc.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#include "vertex.hpp"
+
+namespace {
+
+    class scc_finder {
+    public:
+        explicit scc_finder (std::vector<vertex const *> const & vertices);
+        std::vector<std::vector<vertex const *>> components () && noexcept {
+            return std::move (components_);
+        }
+
+    private:
+        struct state {
+            std::size_t index;
+            std::size_t lowlink;
+            bool on_stack;
+        };
+
+        void connect (vertex const * v);
+
+        /// The vertices being considered. Vertices with a null state haven't yet been visited.
+        std::unordered_map<vertex const *, state *> members_;
+        std::vector<state> states_;
+        std::vector<vertex const *> stack_;
+        std::vector<std::vector<vertex const *>> components_;
+    };
+
+    scc_finder::scc_finder (std::vector<vertex const *> const & vertices) {
+        states_.reserve (vertices.size ());
+        for (vertex const * const v : vertices) {
+            members_.emplace (v, nullptr);
+        }
+        for (vertex const * const v : vertices) {
+            if (members_[v] == nullptr) {
+                this->connect (v);
+            }
+        }
+    }
+
+    void scc_finder::connect (vertex const * const v) {
+        auto const index = states_.size ();
+        state * const vs = &states_.emplace_back (state{index, index, true});
+        members_[v] = vs;
+        stack_.push_back (v);
+
+        for (vertex const * const w : v->out_edges ()) {
+            auto const pos = members_.find (w);
+            if (pos == members_.end ()) {
+                continue;
+            }
+            if (pos->second == nullptr) {
+                this->connect (w);
+                vs->lowlink = std::min (vs->lowlink, members_[w]->lowlink);
+            } else if (pos->second->on_stack) {
+                vs->lowlink = std::min (vs->lowlink, pos->second->index);
+            }
+        }
+
+        if (vs->lowlink == vs->index) {
+            std::vector<vertex const *> component;
+            vertex const * w = nullptr;
+            do {
+                w = stack_.back ();
+                stack_.pop_back ();
+                members_[w]->on_stack = false;
+                component.push_back (w);
+            } while (w != v);
+            components_.push_back (std::move (component));
+        }
+    }
+
+} // end anonymous namespace
+
+std::vector<std::vector<vertex const *>>
+strongly_connected_components (std::vector<vertex const *> const & vertices) {
+    return scc_finder{vertices}.components ();
+}
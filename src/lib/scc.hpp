@@ -0,0 +1,17 @@
+#ifndef SCC_HPP
+#define SCC_HPP
+
+#include <vector>
+
+class vertex;
+
+/// Finds the strongly connected components of a graph using Tarjan's algorithm.
+///
+/// \param vertices  The vertices to be considered. Edges to vertices which are not in this
+///   collection are ignored.
+/// \returns The strongly connected components of the graph. Each vertex appears in exactly one
+///   component.
+std::vector<std::vector<vertex const *>>
+strongly_connected_components (std::vector<vertex const *> const & vertices);
+
+#endif // SCC_HPP
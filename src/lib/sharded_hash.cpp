@@ -0,0 +1,1384 @@
+#include "sharded_hash.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "config.hpp"
+#include "file_source.hpp"
+#include "graph_source.hpp"
+#include "lazy_hash.hpp"
+#include "scc.hpp"
+#include "vertex.hpp"
+
+namespace {
+
+    /// An owning wrapper for a file descriptor.
+    class descriptor {
+    public:
+        descriptor () noexcept = default;
+        explicit descriptor (int const fd) noexcept
+                : fd_{fd} {}
+        descriptor (descriptor && other) noexcept
+                : fd_{std::exchange (other.fd_, -1)} {}
+        descriptor (descriptor const &) = delete;
+        ~descriptor () noexcept { this->reset (); }
+
+        descriptor & operator= (descriptor && other) noexcept {
+            if (&other != this) {
+                this->reset ();
+                fd_ = std::exchange (other.fd_, -1);
+            }
+            return *this;
+        }
+        descriptor & operator= (descriptor const &) = delete;
+
+        int get () const noexcept { return fd_; }
+        void reset () noexcept {
+            if (fd_ != -1) {
+                ::close (fd_);
+                fd_ = -1;
+            }
+        }
+
+    private:
+        int fd_ = -1;
+    };
+
+    /// Creates a pair of connected Unix domain sockets.
+    std::pair<descriptor, descriptor> make_socket_pair () {
+        int fds[2];
+        if (::socketpair (AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            throw std::system_error (errno, std::generic_category (), "socketpair");
+        }
+        return {descriptor{fds[0]}, descriptor{fds[1]}};
+    }
+
+    void send_bytes (int const fd, void const * const ptr, std::size_t size) {
+        auto * p = static_cast<char const *> (ptr);
+        while (size > 0) {
+            auto const sent = ::send (fd, p, size, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error (errno, std::generic_category (), "send");
+            }
+            p += sent;
+            size -= static_cast<std::size_t> (sent);
+        }
+    }
+
+    /// A buffered connection. The values written to a stream are held until flush() is called so
+    /// that they are sent with a single system call. Values are read from a buffer which is
+    /// refilled with as much data as has arrived. One thread may read from a stream while another
+    /// writes.
+    class stream {
+    public:
+        explicit stream (int const fd) noexcept
+                : fd_{fd} {}
+
+        int fd () const noexcept { return fd_; }
+
+        void write (void const * const ptr, std::size_t const size) {
+            out_.append (static_cast<char const *> (ptr), size);
+        }
+        /// Returns the number of bytes which have been written but not yet sent.
+        std::size_t unsent () const noexcept { return out_.size (); }
+        void flush () {
+            send_bytes (fd_, out_.data (), out_.size ());
+            out_.clear ();
+        }
+
+        /// Reads exactly \p size bytes.
+        ///
+        /// \returns False if the stream ended before any bytes were read, true otherwise.
+        bool read (void * ptr, std::size_t size);
+        /// Returns true if data has been received which hasn't yet been read.
+        bool buffered () const noexcept { return pos_ < end_; }
+
+    private:
+        static constexpr std::size_t buffer_size = 64 * 1024;
+
+        int fd_;
+        std::string out_;
+        std::vector<char> in_;
+        std::size_t pos_ = 0;
+        std::size_t end_ = 0;
+    };
+
+    bool stream::read (void * const ptr, std::size_t size) {
+        auto * p = static_cast<char *> (ptr);
+        auto const total = size;
+        while (size > 0) {
+            if (pos_ == end_) {
+                in_.resize (buffer_size);
+                auto const received = ::recv (fd_, in_.data (), in_.size (), 0);
+                if (received < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error (errno, std::generic_category (), "recv");
+                }
+                if (received == 0) {
+                    if (size == total) {
+                        return false;
+                    }
+                    throw std::runtime_error ("unexpected end of stream");
+                }
+                pos_ = 0;
+                end_ = static_cast<std::size_t> (received);
+            }
+            auto const n = std::min (size, end_ - pos_);
+            std::memcpy (p, &in_[pos_], n);
+            pos_ += n;
+            p += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    template <typename T>
+    void send_value (stream & s, T const & t) {
+        static_assert (std::is_trivially_copyable_v<T>);
+        s.write (&t, sizeof (t));
+    }
+    template <typename T>
+    T recv_value (stream & s) {
+        static_assert (std::is_trivially_copyable_v<T>);
+        T t;
+        if (!s.read (&t, sizeof (t))) {
+            throw std::runtime_error ("unexpected end of stream");
+        }
+        return t;
+    }
+
+    void send_string (stream & s, std::string const & str) {
+        send_value (s, std::uint64_t{str.length ()});
+        s.write (str.data (), str.length ());
+    }
+    std::string recv_string (stream & s) {
+        std::string str (static_cast<std::size_t> (recv_value<std::uint64_t> (s)), '\0');
+        if (!str.empty () && !s.read (&str[0], str.length ())) {
+            throw std::runtime_error ("unexpected end of stream");
+        }
+        return str;
+    }
+
+    void send_id (stream & s, vertex_id const v) { send_value (s, std::uint64_t{v}); }
+    vertex_id recv_id (stream & s) {
+        return static_cast<vertex_id> (recv_value<std::uint64_t> (s));
+    }
+
+#ifdef FNV1_HASH_ENABLED
+    void send_digest (stream & s, hash::digest const & d) { send_value (s, d); }
+    hash::digest recv_digest (stream & s) { return recv_value<hash::digest> (s); }
+#else
+    void send_digest (stream & s, hash::digest const & d) { send_string (s, d); }
+    hash::digest recv_digest (stream & s) { return recv_string (s); }
+#endif // FNV1_HASH_ENABLED
+
+
+
+    /// The messages exchanged between processes. An "activation" is a message which may give a
+    /// worker more work to do. The coordinator counts the activations that it sends to each worker;
+    /// a worker is known to be idle once it reports that it is idle having received all of them.
+    enum class message : char {
+        // Worker to coordinator.
+        digest_request = 'D', ///< Followed by a vertex id. Answered by resolved once known.
+        digest_query = 'Q',   ///< Followed by a vertex id. Answered by known or unknown.
+        result = 'V',         ///< Followed by a vertex id and its digest.
+        idle = 'I',           ///< Followed by the number of activations received.
+        waiting = 'W',        ///< Answers report: followed by the waiting vertices' out-edges.
+        statistics = 'T',     ///< Answers shutdown: followed by the worker's shard_stats.
+        failure = 'F',        ///< Followed by an error message.
+        // Coordinator to worker.
+        known = 'K',    ///< Followed by a digest.
+        unknown = 'U',  ///< The digest is not yet known.
+        resolved = 'N', ///< An activation: followed by a vertex id and its digest.
+        walk = 'L',     ///< An activation: followed by a count and that many vertex ids.
+        report = 'P',   ///< Asks for the vertices which are waiting for other shards' digests.
+        shutdown = 'S', ///< Every digest is known.
+        // Worker to worker.
+        record_request = 'R', ///< Followed by a vertex id.
+    };
+
+    /// Thrown by shard_source::known_digest() when a traversal reaches another shard's vertex
+    /// whose digest is not yet known.
+    struct unresolved {
+        vertex_id v;
+    };
+
+    /// Thrown when the coordinator closes its connection to a worker. The coordinator already
+    /// knows why it did so.
+    struct cancelled {};
+
+
+    /// Returns the number of vertices in the graph file at \p path.
+    std::size_t count_vertices (std::string const & path) {
+        std::ifstream file{path};
+        if (!file) {
+            throw std::runtime_error ("could not open \"" + path + '"');
+        }
+        auto size = std::size_t{0};
+        std::string line;
+        while (std::getline (file, line)) {
+            ++size;
+        }
+        return size;
+    }
+
+    /// The records of the vertices owned by one worker process.
+    class shard {
+    public:
+        shard (std::string const & path, unsigned index, unsigned count);
+
+        unsigned index () const noexcept { return index_; }
+        /// Returns the number of vertices in the whole graph.
+        std::size_t size () const noexcept { return size_; }
+        /// Returns the number of vertices owned by this shard.
+        std::size_t owned () const noexcept { return records_.size (); }
+        /// Returns the id of the n'th vertex owned by this shard.
+        vertex_id id (std::size_t const n) const noexcept { return n * count_ + index_; }
+        unsigned owner (vertex_id const v) const noexcept {
+            return static_cast<unsigned> (v % count_);
+        }
+        /// Returns the record of local vertex \p v.
+        vertex_record const & record (vertex_id const v) const {
+            assert (this->owner (v) == index_);
+            return records_.at (v / count_);
+        }
+
+    private:
+        unsigned const index_;
+        unsigned const count_;
+        std::size_t const size_;
+        /// The records of the local vertices: that of vertex v is at index v / count_.
+        std::vector<vertex_record> records_;
+    };
+
+    shard::shard (std::string const & path, unsigned const index, unsigned const count)
+            : index_{index}
+            , count_{count}
+            , size_{count_vertices (path)} {
+        std::ifstream file{path};
+        if (!file) {
+            throw std::runtime_error ("could not open \"" + path + '"');
+        }
+        // Only the lines describing local vertices are parsed and kept.
+        std::string line;
+        for (auto v = vertex_id{0}; v < size_ && std::getline (file, line); ++v) {
+            if (this->owner (v) == index_) {
+                records_.push_back (parse_vertex_record (line, v, size_));
+            }
+        }
+    }
+
+
+    /// A worker's connection to the coordinator. Messages from the coordinator are read by a
+    /// separate thread so that the coordinator never has to wait for a busy worker.
+    class coordinator_link {
+    public:
+        struct inbound {
+            message kind = message::shutdown;
+            vertex_id v = 0;
+            hash::digest digest{};
+            std::vector<vertex_id> vertices;
+        };
+
+        explicit coordinator_link (int fd);
+        coordinator_link (coordinator_link const &) = delete;
+        coordinator_link & operator= (coordinator_link const &) = delete;
+        ~coordinator_link () noexcept;
+
+        /// Returns the stream on which messages are sent to the coordinator.
+        stream & channel () noexcept { return stream_; }
+
+        /// Sends any unsent messages and waits for the next message which is not a reply to a
+        /// digest query. Throws cancelled if the coordinator closes the connection.
+        inbound pop ();
+        /// Returns the next message which is not a reply to a digest query if one has arrived.
+        std::optional<inbound> try_pop ();
+
+        /// Asks the coordinator to send the digest of vertex \p v in a resolved message once it is
+        /// known.
+        void request_digest (vertex_id v);
+        /// Asks the coordinator for the digest of vertex \p v and waits for the answer.
+        ///
+        /// \returns The digest of \p v or nothing if it is not yet known.
+        std::optional<hash::digest> query_digest (vertex_id v);
+
+    private:
+        /// The body of the thread which reads messages from the coordinator.
+        void receive ();
+        /// Waits for the next message to arrive from the coordinator.
+        inbound next ();
+
+        stream stream_;
+        std::mutex mut_;
+        std::condition_variable cv_;
+        std::deque<inbound> queue_;
+        bool closed_ = false;
+        /// Messages which arrived while we were waiting for the reply to a digest query.
+        std::deque<inbound> deferred_;
+        std::thread thread_;
+    };
+
+    coordinator_link::coordinator_link (int const fd)
+            : stream_{fd}
+            , thread_{&coordinator_link::receive, this} {}
+
+    coordinator_link::~coordinator_link () noexcept {
+        ::shutdown (stream_.fd (), SHUT_RD);
+        thread_.join ();
+    }
+
+    void coordinator_link::receive () {
+        try {
+            inbound in;
+            while (stream_.read (&in.kind, sizeof (in.kind))) {
+                switch (in.kind) {
+                case message::known: in.digest = recv_digest (stream_); break;
+                case message::resolved:
+                    in.v = recv_id (stream_);
+                    in.digest = recv_digest (stream_);
+                    break;
+                case message::walk: {
+                    auto const size = recv_value<std::uint64_t> (stream_);
+                    for (auto ctr = std::uint64_t{0}; ctr < size; ++ctr) {
+                        in.vertices.push_back (recv_id (stream_));
+                    }
+                } break;
+                case message::unknown:
+                case message::report:
+                case message::shutdown: break;
+                case message::digest_request:
+                case message::digest_query:
+                case message::result:
+                case message::idle:
+                case message::waiting:
+                case message::statistics:
+                case message::failure:
+                case message::record_request:
+                    throw std::runtime_error ("unexpected message from coordinator");
+                }
+                {
+                    std::lock_guard<std::mutex> const lock{mut_};
+                    queue_.push_back (std::exchange (in, inbound{}));
+                }
+                cv_.notify_one ();
+            }
+        } catch (...) {
+            // Treated in the same way as the coordinator closing the connection.
+        }
+        {
+            std::lock_guard<std::mutex> const lock{mut_};
+            closed_ = true;
+        }
+        cv_.notify_one ();
+    }
+
+    auto coordinator_link::next () -> inbound {
+        std::unique_lock<std::mutex> lock{mut_};
+        cv_.wait (lock, [this] () { return closed_ || !queue_.empty (); });
+        if (queue_.empty ()) {
+            throw cancelled{};
+        }
+        inbound in = std::move (queue_.front ());
+        queue_.pop_front ();
+        return in;
+    }
+
+    auto coordinator_link::pop () -> inbound {
+        if (!deferred_.empty ()) {
+            inbound in = std::move (deferred_.front ());
+            deferred_.pop_front ();
+            return in;
+        }
+        stream_.flush ();
+        return this->next ();
+    }
+
+    auto coordinator_link::try_pop () -> std::optional<inbound> {
+        if (!deferred_.empty ()) {
+            return this->pop ();
+        }
+        std::lock_guard<std::mutex> const lock{mut_};
+        if (queue_.empty ()) {
+            return std::nullopt;
+        }
+        inbound in = std::move (queue_.front ());
+        queue_.pop_front ();
+        return in;
+    }
+
+    void coordinator_link::request_digest (vertex_id const v) {
+        send_value (stream_, message::digest_request);
+        send_id (stream_, v);
+    }
+
+    std::optional<hash::digest> coordinator_link::query_digest (vertex_id const v) {
+        send_value (stream_, message::digest_query);
+        send_id (stream_, v);
+        stream_.flush ();
+        for (;;) {
+            inbound in = this->next ();
+            if (in.kind == message::known) {
+                return std::move (in.digest);
+            }
+            if (in.kind == message::unknown) {
+                return std::nullopt;
+            }
+            deferred_.push_back (std::move (in));
+        }
+    }
+
+
+    /// A graph_source which supplies the records of local vertices directly and the digests of
+    /// other shards' vertices by asking the coordinator. Digests are requested when the traversal
+    /// prefetches a vertex's successors so that the requests overlap. A traversal which needs a
+    /// digest which hasn't arrived is abandoned by throwing unresolved.
+    ///
+    /// In walking mode, which is used to hash the members of an SCC which spans shards, the records
+    /// of other shards' vertices whose digests are unknown are fetched from their owners instead.
+    class shard_source final : public graph_source {
+    public:
+        /// \param s  The local shard.
+        /// \param peers  A connection to each shard's worker, indexed by shard. The entry for the
+        ///   local shard is unused.
+        /// \param link  The connection to the coordinator.
+        shard_source (shard const & s, std::vector<descriptor> const & peers,
+                      coordinator_link & link);
+
+        std::shared_future<vertex_record> fetch (vertex_id v) override;
+        std::optional<hash::digest> known_digest (vertex_id v) override;
+
+        /// Enables or disables walking mode.
+        void walking (bool const enabled) noexcept { walking_ = enabled; }
+        /// Records the digest of local vertex \p v, a member of an SCC which spans shards.
+        void walked (vertex_id const v, hash::digest const & d) { walked_.emplace (v, d); }
+        bool was_walked (vertex_id const v) const { return walked_.find (v) != walked_.end (); }
+        /// Records the digest of vertex \p v, which belongs to another shard.
+        void remember (vertex_id v, hash::digest const & d);
+
+        /// Returns the number of records which have been fetched from other shards.
+        std::size_t remote_records () const noexcept { return remote_records_; }
+
+    private:
+        vertex_record remote_record (vertex_id v);
+        /// Asks the coordinator for the digest of vertex \p v, which belongs to another shard,
+        /// unless it has already been asked.
+        void request (vertex_id v);
+
+        shard const & shard_;
+        std::vector<stream> peers_;
+        coordinator_link & link_;
+        bool walking_ = false;
+        std::size_t remote_records_ = 0;
+        /// The digests of the local members of SCCs which span shards. These vertices are never
+        /// memoized.
+        std::unordered_map<vertex_id, hash::digest> walked_;
+        /// The digests of other shards' vertices which have been received. Only the successors of
+        /// local vertices are requested, so the size is limited by the number of local out-edges.
+        std::unordered_map<vertex_id, hash::digest> remote_;
+        /// The vertices whose digests have been requested but not yet received.
+        std::unordered_set<vertex_id> requested_;
+    };
+
+    shard_source::shard_source (shard const & s, std::vector<descriptor> const & peers,
+                                coordinator_link & link)
+            : shard_{s}
+            , link_{link} {
+        peers_.reserve (peers.size ());
+        for (descriptor const & peer : peers) {
+            peers_.emplace_back (peer.get ());
+        }
+    }
+
+    std::shared_future<vertex_record> shard_source::fetch (vertex_id const v) {
+        if (shard_.owner (v) == shard_.index ()) {
+            std::promise<vertex_record> p;
+            p.set_value (shard_.record (v));
+            return p.get_future ();
+        }
+        if (!walking_) {
+            this->request (v);
+        }
+        // Remote records are only requested if they are actually needed, which is only in walking
+        // mode when the vertex's digest is unknown.
+        return std::async (std::launch::deferred, [this, v] () { return this->remote_record (v); });
+    }
+
+    vertex_record shard_source::remote_record (vertex_id const v) {
+        assert (walking_);
+        stream & peer = peers_.at (shard_.owner (v));
+        send_value (peer, message::record_request);
+        send_id (peer, v);
+        peer.flush ();
+
+        vertex_record record;
+        record.name = recv_string (peer);
+        auto const size = recv_value<std::uint64_t> (peer);
+        record.out_edges.reserve (static_cast<std::size_t> (size));
+        for (auto ctr = std::uint64_t{0}; ctr < size; ++ctr) {
+            record.out_edges.push_back (recv_id (peer));
+        }
+        ++remote_records_;
+        return record;
+    }
+
+    void shard_source::request (vertex_id const v) {
+        if (remote_.find (v) == remote_.end () && requested_.insert (v).second) {
+            link_.request_digest (v);
+        }
+    }
+
+    void shard_source::remember (vertex_id const v, hash::digest const & d) {
+        requested_.erase (v);
+        remote_.emplace (v, d);
+    }
+
+    std::optional<hash::digest> shard_source::known_digest (vertex_id const v) {
+        if (shard_.owner (v) == shard_.index ()) {
+            // Memoized local digests are already recorded in the table. The digest of a walked
+            // vertex is valid for a traversal which didn't start inside its SCC. The traversals of
+            // that SCC's members were all done by walking and are finished.
+            auto const pos = walked_.find (v);
+            if (pos == walked_.end ()) {
+                return std::nullopt;
+            }
+            return pos->second;
+        }
+        auto const pos = remote_.find (v);
+        if (pos != remote_.end ()) {
+            return pos->second;
+        }
+        if (walking_) {
+            // If the digest is unknown, the vertex belongs to the SCC being walked: the coordinator
+            // holds back the digests of its members until all of them are known.
+            return link_.query_digest (v);
+        }
+        this->request (v);
+        throw unresolved{v};
+    }
+
+
+    /// Answers the record requests of another worker until it closes the connection.
+    void serve (shard const & s, int const fd) {
+        stream peer{fd};
+        message m;
+        while (peer.read (&m, sizeof (m))) {
+            if (m != message::record_request) {
+                throw std::runtime_error ("unexpected request");
+            }
+            vertex_record const & record = s.record (recv_id (peer));
+            send_string (peer, record.name);
+            send_value (peer, std::uint64_t{record.out_edges.size ()});
+            for (vertex_id const out : record.out_edges) {
+                send_id (peer, out);
+            }
+            peer.flush ();
+        }
+    }
+
+    /// Owns the threads which serve requests from other workers. If the threads have not been
+    /// joined when the group is destroyed, their connections are shut down so that they stop
+    /// waiting for requests, and they are then joined.
+    class server_threads {
+    public:
+        server_threads () = default;
+        server_threads (server_threads const &) = delete;
+        server_threads & operator= (server_threads const &) = delete;
+        ~server_threads () noexcept {
+            for (int const fd : fds_) {
+                ::shutdown (fd, SHUT_RDWR);
+            }
+            this->join ();
+        }
+
+        /// Starts a thread which answers the requests arriving on \p fd.
+        void start (shard const & s, int const fd) {
+            fds_.push_back (fd);
+            threads_.emplace_back ([&s, fd] () {
+                try {
+                    serve (s, fd);
+                } catch (...) {
+                    // The peer failed or we were shut down. A failed peer reports its own error.
+                }
+            });
+        }
+        /// Waits for every peer to close its connection.
+        void join () noexcept {
+            for (std::thread & t : threads_) {
+                if (t.joinable ()) {
+                    t.join ();
+                }
+            }
+        }
+
+    private:
+        std::vector<int> fds_;
+        std::vector<std::thread> threads_;
+    };
+
+
+    /// Hashes the vertices of one shard.
+    class shard_worker {
+    public:
+        /// \param s  The local shard.
+        /// \param peers  A connection to each shard's worker, indexed by shard.
+        /// \param coordinator  The connection to the coordinating process.
+        shard_worker (shard const & s, std::vector<descriptor> const & peers, int coordinator);
+
+        /// Hashes the shard's vertices until the coordinator reports that every digest is known.
+        void run ();
+
+    private:
+        /// The number of unsent bytes at which results are sent without waiting for the worker to
+        /// become idle.
+        static constexpr std::size_t flush_threshold = 4096;
+
+        /// Hashes local vertex \p v or, if it needs a digest which isn't yet known, makes it wait.
+        void hash_vertex (vertex_id v);
+        /// Makes the vertices which were waiting for the digest of vertex \p v ready once more.
+        void release (vertex_id v, hash::digest const & d);
+        /// Hashes the local members of SCCs which span shards.
+        void walk (std::vector<vertex_id> const & vertices);
+        /// Sends the out-edges of each waiting vertex to the coordinator.
+        void report ();
+        void send_result (vertex_id v, hash::digest const & d);
+
+        shard const & shard_;
+        coordinator_link link_;
+        shard_source source_;
+        lazy_memoized_hashes table_;
+        /// The local vertices which are ready to be hashed. The last is hashed next.
+        std::vector<vertex_id> ready_;
+        /// Each local vertex which is waiting for the digest of another shard's vertex, along with
+        /// the vertex for which it is waiting.
+        std::unordered_map<vertex_id, vertex_id> waiting_;
+        /// The local vertices which are waiting for the digest of each of other shards' vertices.
+        std::unordered_map<vertex_id, std::vector<vertex_id>> waiters_;
+    };
+
+    shard_worker::shard_worker (shard const & s, std::vector<descriptor> const & peers,
+                                int const coordinator)
+            : shard_{s}
+            , link_{coordinator}
+            , source_{s, peers, link_} {
+        ready_.reserve (s.owned ());
+        for (auto n = s.owned (); n > 0U; --n) {
+            ready_.push_back (s.id (n - 1U));
+        }
+    }
+
+    void shard_worker::run () {
+        auto activations = std::uint64_t{0};
+        bool idle = false;
+        for (;;) {
+            std::optional<coordinator_link::inbound> in = link_.try_pop ();
+            if (!in) {
+                if (!ready_.empty ()) {
+                    vertex_id const v = ready_.back ();
+                    ready_.pop_back ();
+                    this->hash_vertex (v);
+                    if (link_.channel ().unsent () >= flush_threshold) {
+                        link_.channel ().flush ();
+                    }
+                    continue;
+                }
+                if (!idle) {
+                    send_value (link_.channel (), message::idle);
+                    send_value (link_.channel (), activations);
+                    idle = true;
+                }
+                in = link_.pop ();
+            }
+
+            switch (in->kind) {
+            case message::resolved:
+                ++activations;
+                idle = false;
+                this->release (in->v, in->digest);
+                break;
+            case message::walk:
+                ++activations;
+                idle = false;
+                this->walk (in->vertices);
+                break;
+            case message::report: this->report (); break;
+            case message::shutdown:
+                send_value (link_.channel (), message::statistics);
+                send_value (link_.channel (), std::uint64_t{shard_.owned ()});
+                send_value (link_.channel (), std::uint64_t{table_.size ()});
+                send_value (link_.channel (), std::uint64_t{source_.remote_records ()});
+                link_.channel ().flush ();
+                return;
+            case message::known:
+            case message::unknown:
+            case message::digest_request:
+            case message::digest_query:
+            case message::result:
+            case message::idle:
+            case message::waiting:
+            case message::statistics:
+            case message::failure:
+            case message::record_request:
+                throw std::runtime_error ("unexpected message from coordinator");
+            }
+        }
+    }
+
+    void shard_worker::hash_vertex (vertex_id const v) {
+        if (source_.was_walked (v)) {
+            return;
+        }
+        try {
+            this->send_result (v, lazy_vertex_hash (source_, v, &table_));
+        } catch (unresolved const & u) {
+            waiting_.emplace (v, u.v);
+            waiters_[u.v].push_back (v);
+        }
+    }
+
+    void shard_worker::release (vertex_id const v, hash::digest const & d) {
+        source_.remember (v, d);
+        auto const pos = waiters_.find (v);
+        if (pos == waiters_.end ()) {
+            return;
+        }
+        for (vertex_id const w : pos->second) {
+            // A waiting vertex may have been walked since it started to wait.
+            auto const wpos = waiting_.find (w);
+            if (wpos != waiting_.end () && wpos->second == v) {
+                waiting_.erase (wpos);
+                ready_.push_back (w);
+            }
+        }
+        waiters_.erase (pos);
+    }
+
+    void shard_worker::walk (std::vector<vertex_id> const & vertices) {
+        std::vector<hash::digest> digests;
+        digests.reserve (vertices.size ());
+        source_.walking (true);
+        for (vertex_id const v : vertices) {
+            digests.push_back (lazy_vertex_hash (source_, v, &table_));
+            waiting_.erase (v);
+            this->send_result (v, digests.back ());
+        }
+        source_.walking (false);
+        // These digests must not be used by the walks above since each vertex's SCC is walked from
+        // every one of its members.
+        for (auto index = std::size_t{0}; index < vertices.size (); ++index) {
+            source_.walked (vertices[index], digests[index]);
+        }
+    }
+
+    void shard_worker::report () {
+        stream & s = link_.channel ();
+        send_value (s, message::waiting);
+        send_value (s, std::uint64_t{waiting_.size ()});
+        for (auto const & w : waiting_) {
+            auto const & out_edges = shard_.record (w.first).out_edges;
+            send_id (s, w.first);
+            send_value (s, std::uint64_t{out_edges.size ()});
+            for (vertex_id const out : out_edges) {
+                send_id (s, out);
+            }
+        }
+    }
+
+    void shard_worker::send_result (vertex_id const v, hash::digest const & d) {
+        send_value (link_.channel (), message::result);
+        send_id (link_.channel (), v);
+        send_digest (link_.channel (), d);
+    }
+
+    /// The body of a worker process.
+    ///
+    /// \param path  The path of the graph file.
+    /// \param index  The index of this worker's shard.
+    /// \param count  The total number of shards.
+    /// \param clients  The connections on which this worker sends requests to other workers,
+    ///   indexed by shard.
+    /// \param servers  The connections on which other workers send requests to this one.
+    /// \param coordinator  The connection to the coordinating process.
+    void worker (std::string const & path, unsigned const index, unsigned const count,
+                 std::vector<descriptor> clients, std::vector<descriptor> servers,
+                 int const coordinator) {
+        shard const s{path, index, count};
+
+        server_threads threads;
+        for (descriptor const & server : servers) {
+            if (server.get () != -1) {
+                threads.start (s, server.get ());
+            }
+        }
+
+        shard_worker{s, clients, coordinator}.run ();
+
+        // Other workers may still be walking and need our records: keep serving them until they
+        // close their connections.
+        clients.clear ();
+        threads.join ();
+    }
+
+
+    /// The coordinating process's view of the workers. It holds the digest of every vertex and
+    /// answers the workers' requests for them.
+    class coordinator {
+    public:
+        /// \param workers  The connection to each worker, indexed by shard.
+        /// \param size  The number of vertices in the graph.
+        coordinator (std::vector<descriptor> const & workers, std::size_t size);
+
+        /// Serves the workers until every digest is known.
+        void run ();
+        /// Tells the workers that every digest is known.
+        ///
+        /// \returns The statistics of each worker.
+        std::vector<shard_stats> stop ();
+        /// Tells the workers to stop after a failure and waits for them to close their connections.
+        ///
+        /// \returns The failures reported by the workers.
+        std::vector<std::string> abort ();
+
+        std::vector<hash::digest> digests () && noexcept { return std::move (digests_); }
+
+    private:
+        /// A strongly connected component whose members are being walked.
+        struct component {
+            std::vector<vertex_id> members;
+            /// The number of members whose digests have not yet been received.
+            std::size_t outstanding = 0;
+        };
+
+        /// Handles a message from worker \p k.
+        void receive (unsigned k);
+        /// Reads the header of a message from worker \p k, which is expected to be \p m.
+        void expect (unsigned k, message m);
+        /// Records the digest of vertex \p v.
+        void record (vertex_id v, hash::digest const & d);
+        /// Sends the digest of vertex \p v to the workers which are waiting for it.
+        void release (vertex_id v);
+        /// Sends the digest of vertex \p v to worker \p k.
+        void send_resolved (unsigned k, vertex_id v);
+        /// Notes that an activation has been sent to worker \p k.
+        void activate (unsigned k);
+        /// Finds the SCCs of waiting vertices which depend on no other waiting vertex and tells
+        /// their owners to walk them.
+        void walk_components ();
+        /// Sends the messages which are waiting in the workers' streams.
+        void flush ();
+
+        std::vector<stream> workers_;
+        std::vector<hash::digest> digests_;
+        /// True for each vertex whose digest has been released.
+        std::vector<bool> known_;
+        std::size_t known_count_ = 0;
+        /// The workers which are waiting for the digest of each vertex.
+        std::unordered_map<vertex_id, std::vector<unsigned>> subscribers_;
+        /// The number of activations sent to each worker.
+        std::vector<std::uint64_t> activations_;
+        /// True for each worker which has reported that it is idle after receiving all of its
+        /// activations.
+        std::vector<bool> idle_;
+        std::vector<component> components_;
+        /// The index of the component to which each vertex being walked belongs.
+        std::unordered_map<vertex_id, std::size_t> walking_;
+    };
+
+    coordinator::coordinator (std::vector<descriptor> const & workers, std::size_t const size)
+            : digests_ (size)
+            , known_ (size, false)
+            , activations_ (workers.size (), 0U)
+            , idle_ (workers.size (), false) {
+        workers_.reserve (workers.size ());
+        for (descriptor const & w : workers) {
+            workers_.emplace_back (w.get ());
+        }
+    }
+
+    void coordinator::run () {
+        std::vector<pollfd> fds (workers_.size ());
+        for (auto k = std::size_t{0}; k < workers_.size (); ++k) {
+            fds[k].fd = workers_[k].fd ();
+            fds[k].events = POLLIN;
+        }
+        for (;;) {
+            // Messages which have already been read into a buffer won't wake poll().
+            for (auto k = 0U; k < workers_.size (); ++k) {
+                while (workers_[k].buffered ()) {
+                    this->receive (k);
+                }
+            }
+            this->flush ();
+            if (std::all_of (idle_.begin (), idle_.end (), [] (bool const i) { return i; })) {
+                if (known_count_ == digests_.size ()) {
+                    return;
+                }
+                this->walk_components ();
+                continue;
+            }
+            while (::poll (fds.data (), fds.size (), -1) < 0) {
+                if (errno != EINTR) {
+                    throw std::system_error (errno, std::generic_category (), "poll");
+                }
+            }
+            for (auto k = 0U; k < fds.size (); ++k) {
+                if (fds[k].revents != 0) {
+                    this->receive (k);
+                }
+            }
+        }
+    }
+
+    void coordinator::receive (unsigned const k) {
+        stream & fd = workers_[k];
+        std::string failure;
+        try {
+            message m;
+            if (!fd.read (&m, sizeof (m))) {
+                throw std::runtime_error ("worker exited unexpectedly");
+            }
+            switch (m) {
+            case message::digest_request: {
+                vertex_id const v = recv_id (fd);
+                if (known_.at (v)) {
+                    this->send_resolved (k, v);
+                } else {
+                    std::vector<unsigned> & s = subscribers_[v];
+                    if (std::find (s.begin (), s.end (), k) == s.end ()) {
+                        s.push_back (k);
+                    }
+                }
+            } break;
+            case message::digest_query: {
+                vertex_id const v = recv_id (fd);
+                if (known_.at (v)) {
+                    send_value (fd, message::known);
+                    send_digest (fd, digests_[v]);
+                } else {
+                    send_value (fd, message::unknown);
+                }
+            } break;
+            case message::result: {
+                vertex_id const v = recv_id (fd);
+                this->record (v, recv_digest (fd));
+            } break;
+            case message::idle: idle_[k] = recv_value<std::uint64_t> (fd) == activations_[k]; break;
+            case message::failure: failure = recv_string (fd); break;
+            case message::waiting:
+            case message::statistics:
+            case message::known:
+            case message::unknown:
+            case message::resolved:
+            case message::walk:
+            case message::report:
+            case message::shutdown:
+            case message::record_request:
+                throw std::runtime_error ("unexpected message from worker");
+            }
+        } catch (std::exception const & ex) {
+            failure = "shard " + std::to_string (k) + ": " + ex.what ();
+        }
+        if (!failure.empty ()) {
+            throw std::runtime_error (failure);
+        }
+    }
+
+    void coordinator::expect (unsigned const k, message const m) {
+        stream & fd = workers_[k];
+        std::string failure;
+        try {
+            message actual;
+            if (!fd.read (&actual, sizeof (actual))) {
+                throw std::runtime_error ("worker exited unexpectedly");
+            }
+            if (actual == message::failure) {
+                failure = recv_string (fd);
+            } else if (actual != m) {
+                throw std::runtime_error ("unexpected message from worker");
+            }
+        } catch (std::exception const & ex) {
+            failure = "shard " + std::to_string (k) + ": " + ex.what ();
+        }
+        if (!failure.empty ()) {
+            throw std::runtime_error (failure);
+        }
+    }
+
+    void coordinator::record (vertex_id const v, hash::digest const & d) {
+        digests_.at (v) = d;
+        auto const pos = walking_.find (v);
+        if (pos == walking_.end ()) {
+            this->release (v);
+            return;
+        }
+        component & c = components_[pos->second];
+        walking_.erase (pos);
+        assert (c.outstanding > 0U);
+        if (--c.outstanding == 0U) {
+            for (vertex_id const member : c.members) {
+                this->release (member);
+            }
+            c.members.clear ();
+        }
+    }
+
+    void coordinator::release (vertex_id const v) {
+        assert (!known_[v]);
+        known_[v] = true;
+        ++known_count_;
+        auto const pos = subscribers_.find (v);
+        if (pos == subscribers_.end ()) {
+            return;
+        }
+        for (unsigned const k : pos->second) {
+            this->send_resolved (k, v);
+        }
+        subscribers_.erase (pos);
+    }
+
+    void coordinator::send_resolved (unsigned const k, vertex_id const v) {
+        stream & fd = workers_[k];
+        send_value (fd, message::resolved);
+        send_id (fd, v);
+        send_digest (fd, digests_[v]);
+        this->activate (k);
+    }
+
+    void coordinator::activate (unsigned const k) {
+        ++activations_[k];
+        idle_[k] = false;
+    }
+
+    void coordinator::flush () {
+        for (stream & w : workers_) {
+            if (w.unsent () > 0U) {
+                w.flush ();
+            }
+        }
+    }
+
+    void coordinator::walk_components () {
+        // Every worker is idle, so each vertex whose digest is unknown is waiting for that of
+        // another shard's vertex. Build a graph of these vertices.
+        assert (walking_.empty ());
+        std::vector<vertex_id> ids;
+        std::vector<std::vector<vertex_id>> out_edges;
+        for (auto k = 0U; k < workers_.size (); ++k) {
+            send_value (workers_[k], message::report);
+        }
+        this->flush ();
+        for (auto k = 0U; k < workers_.size (); ++k) {
+            stream & fd = workers_[k];
+            this->expect (k, message::waiting);
+            auto const size = recv_value<std::uint64_t> (fd);
+            for (auto ctr = std::uint64_t{0}; ctr < size; ++ctr) {
+                ids.push_back (recv_id (fd));
+                auto & out = out_edges.emplace_back (recv_value<std::uint64_t> (fd));
+                for (vertex_id & o : out) {
+                    o = recv_id (fd);
+                }
+            }
+        }
+
+        std::vector<vertex> graph;
+        graph.reserve (ids.size ());
+        std::unordered_map<vertex_id, vertex *> index;
+        for (vertex_id const v : ids) {
+            index.emplace (v, &graph.emplace_back (std::to_string (v)));
+        }
+        std::vector<vertex const *> members;
+        members.reserve (graph.size ());
+        for (auto n = std::size_t{0}; n < graph.size (); ++n) {
+            for (vertex_id const out : out_edges[n]) {
+                auto const pos = index.find (out);
+                if (pos != index.end ()) {
+                    graph[n].add_edge (pos->second);
+                }
+            }
+            members.push_back (&graph[n]);
+        }
+
+        // The SCCs with no edges to another SCC depend only on vertices whose digests are known.
+        auto const sccs = strongly_connected_components (members);
+        std::unordered_map<vertex const *, std::size_t> component_of;
+        for (auto c = std::size_t{0}; c < sccs.size (); ++c) {
+            for (vertex const * const v : sccs[c]) {
+                component_of.emplace (v, c);
+            }
+        }
+        std::vector<std::vector<vertex_id>> orders (workers_.size ());
+        for (auto c = std::size_t{0}; c < sccs.size (); ++c) {
+            bool const independent =
+                std::all_of (sccs[c].begin (), sccs[c].end (), [&] (vertex const * const v) {
+                    return std::all_of (
+                        v->out_edges ().begin (), v->out_edges ().end (),
+                        [&] (vertex const * const out) { return component_of[out] == c; });
+                });
+            if (!independent) {
+                continue;
+            }
+            component & comp = components_.emplace_back ();
+            for (vertex const * const v : sccs[c]) {
+                vertex_id const id = ids[static_cast<std::size_t> (v - graph.data ())];
+                comp.members.push_back (id);
+                walking_.emplace (id, components_.size () - 1U);
+                orders[id % workers_.size ()].push_back (id);
+            }
+            comp.outstanding = comp.members.size ();
+        }
+        if (walking_.empty ()) {
+            throw std::runtime_error ("sharded hashing can make no progress");
+        }
+
+        for (auto k = 0U; k < workers_.size (); ++k) {
+            if (!orders[k].empty ()) {
+                stream & fd = workers_[k];
+                send_value (fd, message::walk);
+                send_value (fd, std::uint64_t{orders[k].size ()});
+                for (vertex_id const v : orders[k]) {
+                    send_id (fd, v);
+                }
+                this->activate (k);
+            }
+        }
+    }
+
+    std::vector<shard_stats> coordinator::stop () {
+        for (stream & w : workers_) {
+            send_value (w, message::shutdown);
+        }
+        this->flush ();
+        std::vector<shard_stats> result (workers_.size ());
+        for (auto k = 0U; k < workers_.size (); ++k) {
+            stream & fd = workers_[k];
+            this->expect (k, message::statistics);
+            result[k].vertices = static_cast<std::size_t> (recv_value<std::uint64_t> (fd));
+            result[k].memoized = static_cast<std::size_t> (recv_value<std::uint64_t> (fd));
+            result[k].remote_records = static_cast<std::size_t> (recv_value<std::uint64_t> (fd));
+        }
+        return result;
+    }
+
+    /// Reads the messages sent by a worker which has been told to stop until it closes its
+    /// connection.
+    ///
+    /// \returns The worker's description of its failure or an empty string if it didn't send one.
+    std::string drain (stream & fd) {
+        try {
+            message m;
+            while (fd.read (&m, sizeof (m))) {
+                switch (m) {
+                case message::digest_request:
+                case message::digest_query: recv_id (fd); break;
+                case message::result:
+                    recv_id (fd);
+                    recv_digest (fd);
+                    break;
+                case message::idle: recv_value<std::uint64_t> (fd); break;
+                case message::waiting: {
+                    auto const size = recv_value<std::uint64_t> (fd);
+                    for (auto ctr = std::uint64_t{0}; ctr < size; ++ctr) {
+                        recv_id (fd);
+                        auto const edges = recv_value<std::uint64_t> (fd);
+                        for (auto e = std::uint64_t{0}; e < edges; ++e) {
+                            recv_id (fd);
+                        }
+                    }
+                } break;
+                case message::statistics:
+                    for (auto ctr = 0; ctr < 3; ++ctr) {
+                        recv_value<std::uint64_t> (fd);
+                    }
+                    break;
+                case message::failure: return recv_string (fd);
+                case message::known:
+                case message::unknown:
+                case message::resolved:
+                case message::walk:
+                case message::report:
+                case message::shutdown:
+                case message::record_request: return {};
+                }
+            }
+        } catch (std::exception const &) {
+            // The worker has gone.
+        }
+        return {};
+    }
+
+    std::vector<std::string> coordinator::abort () {
+        // Closing our side of the connections tells the remaining workers to stop. Hear from each
+        // of them before giving up so that every failure is included in the report.
+        for (stream & w : workers_) {
+            ::shutdown (w.fd (), SHUT_WR);
+        }
+        std::vector<std::string> failures;
+        for (stream & w : workers_) {
+            std::string failure = drain (w);
+            if (!failure.empty ()) {
+                failures.push_back (std::move (failure));
+            }
+        }
+        return failures;
+    }
+
+} // end anonymous namespace
+
+std::vector<hash::digest> sharded_vertex_hash (std::string const & path, unsigned const shards,
+                                               std::vector<shard_stats> * const stats) {
+    if (shards == 0U) {
+        throw std::invalid_argument ("at least one shard is required");
+    }
+    std::size_t const size = count_vertices (path);
+
+    // links[a][b] connects a client in worker a to a server in worker b.
+    std::vector<std::vector<std::pair<descriptor, descriptor>>> links (shards);
+    for (auto a = 0U; a < shards; ++a) {
+        links[a].resize (shards);
+        for (auto b = 0U; b < shards; ++b) {
+            if (a != b) {
+                links[a][b] = make_socket_pair ();
+            }
+        }
+    }
+    std::vector<std::pair<descriptor, descriptor>> coordinators;
+    coordinators.reserve (shards);
+    for (auto k = 0U; k < shards; ++k) {
+        coordinators.push_back (make_socket_pair ());
+    }
+
+    std::vector<pid_t> children;
+    auto wait_for_children = [&children] () {
+        bool ok = true;
+        for (pid_t const pid : children) {
+            int status = 0;
+            while (::waitpid (pid, &status, 0) < 0 && errno == EINTR) {
+            }
+            ok = ok && WIFEXITED (status) && WEXITSTATUS (status) == EXIT_SUCCESS;
+        }
+        return ok;
+    };
+
+    for (auto k = 0U; k < shards; ++k) {
+        pid_t const pid = ::fork ();
+        if (pid < 0) {
+            int const error = errno;
+            // Closing the connections causes the workers that have already started to fail and
+            // exit.
+            links.clear ();
+            coordinators.clear ();
+            wait_for_children ();
+            throw std::system_error (error, std::generic_category (), "fork");
+        }
+        if (pid == 0) {
+            // The child process: take ownership of this worker's ends of the connections.
+            std::vector<descriptor> clients (shards);
+            std::vector<descriptor> servers (shards);
+            for (auto other = 0U; other < shards; ++other) {
+                clients[other] = std::move (links[k][other].first);
+                servers[other] = std::move (links[other][k].second);
+            }
+            links.clear ();
+            descriptor const coordinator = std::move (coordinators[k].second);
+            coordinators.clear ();
+
+            int status = EXIT_SUCCESS;
+            std::string error;
+            try {
+                worker (path, k, shards, std::move (clients), std::move (servers),
+                        coordinator.get ());
+            } catch (cancelled const &) {
+                status = EXIT_FAILURE;
+            } catch (std::exception const & ex) {
+                error = ex.what ();
+                status = EXIT_FAILURE;
+            } catch (...) {
+                error = "unknown exception";
+                status = EXIT_FAILURE;
+            }
+            if (!error.empty ()) {
+                // Tell the coordinator why we failed. It may have gone away already.
+                try {
+                    stream s{coordinator.get ()};
+                    send_value (s, message::failure);
+                    send_string (s, "shard " + std::to_string (k) + ": " + error);
+                    s.flush ();
+                } catch (...) {
+                }
+            }
+            ::_exit (status);
+        }
+        children.push_back (pid);
+    }
+
+    // The coordinator doesn't participate in the workers' conversations.
+    links.clear ();
+    std::vector<descriptor> workers;
+    workers.reserve (shards);
+    for (auto & c : coordinators) {
+        c.second.reset ();
+        workers.push_back (std::move (c.first));
+    }
+    coordinators.clear ();
+
+    std::vector<hash::digest> result;
+    std::vector<std::string> failures;
+    coordinator c{workers, size};
+    try {
+        c.run ();
+        std::vector<shard_stats> s = c.stop ();
+        if (stats != nullptr) {
+            *stats = std::move (s);
+        }
+        result = std::move (c).digests ();
+    } catch (std::exception const & ex) {
+        failures.emplace_back (ex.what ());
+        std::vector<std::string> f = c.abort ();
+        failures.insert (failures.end (), std::make_move_iterator (f.begin ()),
+                         std::make_move_iterator (f.end ()));
+    }
+
+    // Closing the connections causes any remaining workers to exit.
+    workers.clear ();
+    bool const ok = wait_for_children ();
+    if (!failures.empty ()) {
+        std::ostringstream os;
+        for (auto index = std::size_t{0}; index < failures.size (); ++index) {
+            os << (index > 0U ? "; " : "") << failures[index];
+        }
+        throw std::runtime_error (os.str ());
+    }
+    if (!ok) {
+        throw std::runtime_error ("a worker process failed");
+    }
+    return result;
+}
@@ -0,0 +1,47 @@
+#ifndef SHARDED_HASH_HPP
+#define SHARDED_HASH_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "hash.hpp"
+
+/// The work done by one of the worker processes of sharded_vertex_hash().
+struct shard_stats {
+    /// The number of vertices owned by the shard.
+    std::size_t vertices = 0;
+    /// The number of digests held in the worker's memoization table.
+    std::size_t memoized = 0;
+    /// The number of vertex records which the worker fetched from other shards.
+    std::size_t remote_records = 0;
+};
+
+/// Computes the hash digest of every vertex of a graph using a number of worker processes, each of
+/// which holds only a subset (a "shard") of the graph's vertices in memory. The results are
+/// identical to those produced by calling vertex_hash() for each vertex of the equivalent
+/// in-memory graph.
+///
+/// Vertex v belongs to shard (v % shards). Each worker reads the records of its own vertices and
+/// hashes only those vertices. The calling process acts as coordinator: it collects the digests
+/// computed by the workers and answers their requests for the digests of other shards' vertices.
+/// A vertex whose traversal reaches a vertex of another shard whose digest is not yet known waits
+/// until the digest is available and is then hashed again.
+///
+/// The members of a strongly connected component (SCC) which spans shards would wait for each
+/// other forever. Once no worker has anything left to do, the coordinator finds the SCCs of the
+/// waiting vertices which depend on no other waiting vertex. The owner of each member of such an
+/// SCC hashes it by walking the SCC, fetching the records of other shards' members from their
+/// owners. The digests of an SCC's members are released only when all of them are known.
+///
+/// Processes communicate through Unix domain sockets. This function forks the calling process and
+/// so must not be called while other threads are running.
+///
+/// \param path  The path of a graph file in the format read by file_source.
+/// \param shards  The number of worker processes to use.
+/// \param stats  If not null, receives the statistics of each worker, indexed by shard.
+/// \returns The digest of each vertex, indexed by vertex id.
+std::vector<hash::digest> sharded_vertex_hash (std::string const & path, unsigned shards,
+                                               std::vector<shard_stats> * const stats = nullptr);
+
+#endif // SHARDED_HASH_HPP
@@ -0,0 +1,19 @@
+#include "sharing_points.hpp"
+
+#include <unordered_map>
+
+#include "vertex.hpp"
+
+sharing_points::sharing_points (std::vector<vertex const *> const & graph,
+                                std::vector<vertex const *> const & roots)
+        : points_ (std::begin (roots), std::end (roots)) {
+    std::unordered_map<vertex const *, std::size_t> in_degree;
+    in_degree.reserve (graph.size ());
+    for (vertex const * const v : graph) {
+        for (vertex const * const out : v->out_edges ()) {
+            if (out != v && ++in_degree[out] == 2U) {
+                points_.insert (out);
+            }
+        }
+    }
+}
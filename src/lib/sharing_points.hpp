@@ -0,0 +1,48 @@
+#ifndef SHARING_POINTS_HPP
+#define SHARING_POINTS_HPP
+
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+class vertex;
+
+/// Selects the vertices whose digests are worth memoizing. A vertex which is reached by a single
+/// edge is looked up in the memo table only if its parent may be hashed again (because the parent
+/// lies on a loop) or if it is requested as a root. A table which stores only the "sharing points"
+/// of a graph (the vertices with more than one incoming edge and the roots) together with the
+/// successors of vertices on loops is usually much smaller than one that stores every memoizable
+/// vertex. Passing an instance of this class to vertex_hash() enables this memo-sparse mode; the
+/// digests that are produced, and the work done to produce them, are unchanged.
+class sharing_points {
+public:
+    /// \param graph  The vertices of the graph. Those with more than one incoming edge are sharing
+    ///   points. An edge from a vertex to itself is not counted: it is always encoded as a
+    ///   back-reference.
+    /// \param roots  The vertices which will be passed to vertex_hash(). A vertex which is
+    ///   requested as a root without being listed here is still memoized, but may already have
+    ///   been hashed (and counted as skipped) in full as the successor of another root.
+    sharing_points (std::vector<vertex const *> const & graph,
+                    std::vector<vertex const *> const & roots);
+
+    /// Returns true if the digest of vertex \p v should be memoized.
+    bool contains (vertex const * const v) const { return points_.count (v) > 0U; }
+
+    /// Records the outcome for a memoizable vertex: \p stored is true if its digest was written
+    /// to the memo table.
+    void record (bool const stored) noexcept { ++(stored ? stored_ : skipped_); }
+
+    /// The number of digests that were written to the memo table.
+    std::size_t stored () const noexcept { return stored_; }
+    /// The number of memoizable vertices whose digests were not written to the memo table. Each
+    /// such vertex is hashed once only, so stored() + skipped() is the size that the table would
+    /// have reached without memo-sparse mode.
+    std::size_t skipped () const noexcept { return skipped_; }
+
+private:
+    std::unordered_set<vertex const *> points_;
+    std::size_t stored_ = 0;
+    std::size_t skipped_ = 0;
+};
+
+#endif // SHARING_POINTS_HPP
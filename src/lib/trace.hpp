@@ -8,7 +8,7 @@
 #include "config.hpp"
 
 #ifdef TRACE_ENABLED
-void trace_impl () {
+inline void trace_impl () {
     // A trace with no arguments is a no-op.
 }
 template <typename T, typename... Args>
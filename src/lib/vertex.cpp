@@ -1,10 +1,14 @@
 #include "vertex.hpp"
 
 #include <ostream>
+#include <utility>
 
 vertex::vertex (std::string const & name, std::initializer_list<vertex const *> adjacent)
         : name_{name}
         , adjacent_{adjacent} {}
+vertex::vertex (std::string const & name, std::vector<vertex const *> adjacent)
+        : name_{name}
+        , adjacent_{std::move (adjacent)} {}
 
 vertex & vertex::add_edge (vertex const * const d) {
     adjacent_.insert (std::end (adjacent_), d);
@@ -11,6 +11,7 @@ class vertex {
 public:
     /// Constructs a new named vertex with zero or more out-going edges.
     explicit vertex (std::string const & name, std::initializer_list<vertex const *> adjacent = {});
+    vertex (std::string const & name, std::vector<vertex const *> adjacent);
 
     vertex & add_edge (vertex const * const d);
     vertex & add_edge (std::initializer_list<vertex const *> d);
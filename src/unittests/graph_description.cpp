@@ -0,0 +1,62 @@
+#include "graph_description.hpp"
+
+#include <fstream>
+#include <list>
+
+#include <gtest/gtest.h>
+
+#include "memhash.hpp"
+#include "vertex.hpp"
+
+std::string write_graph (graph_description const & desc, std::string const & name) {
+    auto const path = testing::TempDir () + name;
+    std::ofstream os{path};
+    for (auto const & [vertex_name, out_edges] : desc) {
+        os << vertex_name;
+        for (vertex_id const out : out_edges) {
+            os << ' ' << out;
+        }
+        os << '\n';
+    }
+    return path;
+}
+
+std::vector<hash::digest> in_memory_digests (graph_description const & desc) {
+    std::list<vertex> graph;
+    std::vector<vertex *> vertices;
+    for (auto const & d : desc) {
+        vertices.push_back (&graph.emplace_back (std::get<std::string> (d)));
+    }
+    for (auto index = std::size_t{0}; index < desc.size (); ++index) {
+        for (vertex_id const out : std::get<std::vector<vertex_id>> (desc[index])) {
+            vertices[index]->add_edge (vertices[out]);
+        }
+    }
+
+    std::vector<hash::digest> result;
+    memoized_hashes table;
+    for (vertex const * const v : vertices) {
+        result.push_back (vertex_hash (v, &table));
+    }
+    return result;
+}
+
+std::list<vertex> sample_graph (bool const f_to_e) {
+    std::list<vertex> graph;
+    vertex & va = graph.emplace_back ("a");
+    vertex & ve = graph.emplace_back ("e");
+    vertex & vg = graph.emplace_back ("g");
+    vertex & vc = graph.emplace_back ("c");
+    vertex & vf = graph.emplace_back ("f");
+    vertex & vb = graph.emplace_back ("b");
+    vertex & vd = graph.emplace_back ("d");
+    va.add_edge ({&vb, &vd});
+    vb.add_edge (&vc);
+    vc.add_edge (&vb);
+    vd.add_edge ({&ve, &vf});
+    vg.add_edge (&ve);
+    if (f_to_e) {
+        vf.add_edge (&ve);
+    }
+    return graph;
+}
@@ -0,0 +1,43 @@
+#ifndef GRAPH_DESCRIPTION_HPP
+#define GRAPH_DESCRIPTION_HPP
+
+#include <list>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "graph_builders.hpp"
+#include "graph_source.hpp"
+#include "hash.hpp"
+#include "vertex.hpp"
+
+/// Describes a graph as a vector of vertex names and the indices of their successors.
+using graph_description = std::vector<std::tuple<std::string, std::vector<vertex_id>>>;
+
+/// Writes the graph described by \p desc to a temporary file in the format expected by
+/// file_source.
+///
+/// \param desc  The graph to be written.
+/// \param name  The name of the file to be created in the test's temporary directory.
+/// \returns The path of the file.
+std::string write_graph (graph_description const & desc, std::string const & name);
+
+/// Hashes each vertex of the graph described by \p desc using vertex_hash().
+std::vector<hash::digest> in_memory_digests (graph_description const & desc);
+
+/// Builds a graph with both cyclic and acyclic paths:
+///
+///     digraph G {
+///         a -> b -> c -> b;
+///         a -> d -> e;
+///         d -> f;
+///         g -> e;
+///     }
+///
+/// The vertices are created in the order a, e, g, c, f, b, d, which is unrelated to the structure
+/// of the graph.
+///
+/// \param f_to_e  If true, the graph gains an edge from f to e.
+std::list<vertex> sample_graph (bool f_to_e = false);
+
+#endif // GRAPH_DESCRIPTION_HPP
@@ -0,0 +1,148 @@
+#include "bounded_hash.hpp"
+
+#include <list>
+#include <set>
+
+#include <gmock/gmock.h>
+
+#include "config.hpp"
+#include "hash.hpp"
+#include "memhash.hpp"
+#include "vertex.hpp"
+
+using namespace std::string_literals;
+
+using testing::UnorderedElementsAre;
+
+#ifdef FNV1_HASH_ENABLED
+#    define STRING_HASH_EXPECT_EQ(val1, val2)
+#else
+#    define STRING_HASH_EXPECT_EQ(val1, val2) EXPECT_EQ (val1, val2)
+#endif // FNV1_HASH_ENABLED
+
+namespace {
+
+    std::set<bounded_key> keys (bounded_memoized_hashes const & table) {
+        std::set<bounded_key> result;
+        for (auto const & kv : table) {
+            result.insert (kv.first);
+        }
+        return result;
+    }
+
+} // end anonymous namespace
+
+// digraph G {
+//     c -> a;
+//     c -> b;
+// }
+TEST (BoundedHash, Simple) {
+    std::list<vertex> graph;
+    vertex const & va = graph.emplace_back ("a");
+    vertex const & vb = graph.emplace_back ("b");
+    vertex const & vc = graph.emplace_back ("c").add_edge ({&va, &vb});
+
+    bounded_memoized_hashes table;
+    auto const d0 = bounded_vertex_hash (&vc, 0U, &table);
+    auto const d1 = bounded_vertex_hash (&vc, 1U, &table);
+    STRING_HASH_EXPECT_EQ (d0, "B0/VcE"s);
+    STRING_HASH_EXPECT_EQ (d1, "B1/Vc/B0/VaE/B0/VbEE"s);
+    EXPECT_NE (d0, d1);
+    // A horizon beyond the furthest vertex still records the horizon.
+    EXPECT_NE (bounded_vertex_hash (&vc, 2U, &table), d1);
+
+    // Bounded digests are never equal to full digests, even when the horizon covers the graph.
+    memoized_hashes full;
+    EXPECT_NE (bounded_vertex_hash (&va, 0U, &table), vertex_hash (&va, &full));
+    EXPECT_NE (d1, vertex_hash (&vc, &full));
+}
+
+// digraph G {
+//     a -> b -> a;
+// }
+TEST (BoundedHash, CycleIsUnrolledToTheHorizon) {
+    std::list<vertex> graph;
+    vertex & va = graph.emplace_back ("a");
+    vertex & vb = graph.emplace_back ("b");
+    va.add_edge (&vb);
+    vb.add_edge (&va);
+
+    bounded_memoized_hashes table;
+    auto const d = bounded_vertex_hash (&va, 2U, &table);
+    STRING_HASH_EXPECT_EQ (d, "B2/Va/B1/Vb/B0/VaEEE"s);
+    EXPECT_THAT (keys (table), UnorderedElementsAre (bounded_key{&va, 2U}, bounded_key{&vb, 1U},
+                                                     bounded_key{&va, 0U}));
+
+    // The next horizon reuses the results recorded for the one below.
+    bounded_vertex_hash (&vb, 3U, &table);
+    EXPECT_THAT (keys (table), UnorderedElementsAre (bounded_key{&va, 2U}, bounded_key{&vb, 1U},
+                                                     bounded_key{&va, 0U}, bounded_key{&vb, 3U}));
+}
+
+// Two graphs which agree near "a" but differ three hops away:
+//
+//     digraph G1 {                digraph G2 {
+//         a -> b -> c -> d;           a -> b -> c -> e;
+//     }                           }
+TEST (BoundedHash, AgreesWithinHorizon) {
+    std::list<vertex> g1;
+    vertex & a1 = g1.emplace_back ("a");
+    vertex & b1 = g1.emplace_back ("b");
+    vertex & c1 = g1.emplace_back ("c");
+    vertex & d1 = g1.emplace_back ("d");
+    a1.add_edge (&b1);
+    b1.add_edge (&c1);
+    c1.add_edge (&d1);
+
+    std::list<vertex> g2;
+    vertex & a2 = g2.emplace_back ("a");
+    vertex & b2 = g2.emplace_back ("b");
+    vertex & c2 = g2.emplace_back ("c");
+    vertex & e2 = g2.emplace_back ("e");
+    a2.add_edge (&b2);
+    b2.add_edge (&c2);
+    c2.add_edge (&e2);
+
+    bounded_memoized_hashes table;
+    for (auto k = std::size_t{0}; k < 3U; ++k) {
+        EXPECT_EQ (bounded_vertex_hash (&a1, k, &table), bounded_vertex_hash (&a2, k, &table))
+            << "horizon " << k;
+    }
+    EXPECT_NE (bounded_vertex_hash (&a1, 3U, &table), bounded_vertex_hash (&a2, 3U, &table));
+
+    memoized_hashes full;
+    EXPECT_NE (vertex_hash (&a1, &full), vertex_hash (&a2, &full));
+}
+
+// Vertices with equal full digests must land in the same bucket at every horizon. The converse
+// does not hold: a self-loop and a two-vertex cycle of identically named vertices unroll to the
+// same tree but have different full digests.
+//
+//     digraph G {
+//         x [label="a"]; y [label="a"]; z [label="a"];
+//         x -> x;
+//         y -> z -> y;
+//     }
+TEST (BoundedHash, ScreensFullDigests) {
+    std::list<vertex> graph;
+    vertex & x = graph.emplace_back ("a");
+    vertex & y = graph.emplace_back ("a");
+    vertex & z = graph.emplace_back ("a");
+    x.add_edge (&x);
+    y.add_edge (&z);
+    z.add_edge (&y);
+
+    memoized_hashes full;
+    auto const fx = vertex_hash (&x, &full);
+    auto const fy = vertex_hash (&y, &full);
+    auto const fz = vertex_hash (&z, &full);
+    EXPECT_EQ (fy, fz);
+    EXPECT_NE (fx, fy);
+
+    bounded_memoized_hashes table;
+    for (auto k = std::size_t{0}; k < 5U; ++k) {
+        auto const by = bounded_vertex_hash (&y, k, &table);
+        EXPECT_EQ (by, bounded_vertex_hash (&z, k, &table)) << "horizon " << k;
+        EXPECT_EQ (by, bounded_vertex_hash (&x, k, &table)) << "horizon " << k;
+    }
+}
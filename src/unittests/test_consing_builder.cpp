@@ -0,0 +1,99 @@
+#include "consing_builder.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "hash.hpp"
+#include "memhash.hpp"
+#include "vertex.hpp"
+
+using namespace std::string_literals;
+
+// Two identical subtrees:
+//
+//     digraph G {
+//         r -> x1 -> l1;
+//         r -> x2 -> l2;
+//     }
+//
+// where x1/x2 are both named "x" and l1/l2 are both named "l".
+TEST (ConsingBuilder, SharesIdenticalVertices) {
+    consing_builder b;
+    vertex const * const l1 = b.make ("l");
+    vertex const * const x1 = b.make ("x", {l1});
+    vertex const * const l2 = b.make ("l");
+    vertex const * const x2 = b.make ("x", {l2});
+    vertex const * const r = b.make ("r", {x1, x2});
+
+    EXPECT_EQ (l1, l2);
+    EXPECT_EQ (x1, x2);
+    EXPECT_EQ (b.vertices ().size (), 3U);
+    EXPECT_EQ (b.requests (), 5U);
+    EXPECT_EQ (b.hits (), 2U);
+
+    // Build the same graph without sharing and check that the digests match.
+    std::list<vertex> graph;
+    vertex const & gl1 = graph.emplace_back ("l");
+    vertex const & gx1 = graph.emplace_back ("x").add_edge (&gl1);
+    vertex const & gl2 = graph.emplace_back ("l");
+    vertex const & gx2 = graph.emplace_back ("x").add_edge (&gl2);
+    vertex const & gr = graph.emplace_back ("r").add_edge ({&gx1, &gx2});
+
+    memoized_hashes consed_table;
+    memoized_hashes plain_table;
+    EXPECT_EQ (vertex_hash (r, &consed_table), vertex_hash (&gr, &plain_table));
+    EXPECT_EQ (vertex_hash (x2, &consed_table), vertex_hash (&gx2, &plain_table));
+    EXPECT_EQ (vertex_hash (l2, &consed_table), vertex_hash (&gl2, &plain_table));
+    EXPECT_EQ (consed_table.size (), 3U);
+    EXPECT_EQ (plain_table.size (), 5U);
+}
+
+TEST (ConsingBuilder, DifferentEdgesAreNotShared) {
+    consing_builder b;
+    vertex const * const a = b.make ("a");
+    vertex const * const c = b.make ("c");
+    vertex const * const xa = b.make ("x", {a});
+    EXPECT_NE (xa, b.make ("x", {c}));
+    EXPECT_NE (xa, b.make ("y", {a}));
+    EXPECT_NE (b.make ("x", {a, c}), b.make ("x", {c, a}));
+    EXPECT_EQ (b.hits (), 0U);
+}
+
+// Open vertices may form cycles and refer to shared vertices:
+//
+//     digraph G {
+//         a -> b -> a;
+//         a -> s -> t;
+//         b -> s;
+//     }
+TEST (ConsingBuilder, OpenVertices) {
+    consing_builder b;
+    vertex const * const t = b.make ("t");
+    vertex const * const s = b.make ("s", {t});
+    vertex & a = b.open ("a");
+    vertex & bb = b.open ("b");
+    a.add_edge ({&bb, s});
+    bb.add_edge ({&a, b.make ("s", {b.make ("t")})});
+    EXPECT_EQ (b.vertices ().size (), 4U);
+
+    std::list<vertex> graph;
+    vertex & ga = graph.emplace_back ("a");
+    vertex & gb = graph.emplace_back ("b");
+    vertex const & gt1 = graph.emplace_back ("t");
+    vertex const & gs1 = graph.emplace_back ("s").add_edge (&gt1);
+    vertex const & gt2 = graph.emplace_back ("t");
+    vertex const & gs2 = graph.emplace_back ("s").add_edge (&gt2);
+    ga.add_edge ({&gb, &gs1});
+    gb.add_edge ({&ga, &gs2});
+
+    memoized_hashes consed_table;
+    memoized_hashes plain_table;
+    EXPECT_EQ (vertex_hash (&a, &consed_table), vertex_hash (&ga, &plain_table));
+    EXPECT_EQ (vertex_hash (&bb, &consed_table), vertex_hash (&gb, &plain_table));
+
+    // A shared vertex may not have an edge to an open vertex.
+    EXPECT_THROW (b.make ("x", {&a}), std::invalid_argument);
+}
@@ -0,0 +1,135 @@
+#include "diff.hpp"
+
+#include <algorithm>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "graph_description.hpp"
+#include "hash.hpp"
+#include "vertex.hpp"
+
+using namespace std::string_literals;
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace {
+
+    /// Computes the changed vertices by brute force: hashing both graphs in full.
+    std::vector<std::string> changed_by_digest (std::list<vertex> const & old_graph,
+                                                std::list<vertex> const & new_graph) {
+        digest_set const od = graph_digests (pointers (old_graph));
+        digest_set const nd = graph_digests (pointers (new_graph));
+        std::vector<std::string> result;
+        for (vertex const & v : new_graph) {
+            auto const pos = od.find (v.name ());
+            if (pos != od.end () && pos->second != nd.at (v.name ())) {
+                result.push_back (v.name ());
+            }
+        }
+        std::sort (std::begin (result), std::end (result));
+        return result;
+    }
+
+} // end anonymous namespace
+
+TEST (Diff, Identical) {
+    auto const g1 = sample_graph (false);
+    auto const g2 = sample_graph (false);
+    graph_diff const d = diff_graphs (pointers (g1), pointers (g2));
+    EXPECT_THAT (d.added, IsEmpty ());
+    EXPECT_THAT (d.removed, IsEmpty ());
+    EXPECT_THAT (d.changed, IsEmpty ());
+    EXPECT_THAT (d.root_causes, IsEmpty ());
+
+    graph_diff const dd = diff_digests (graph_digests (pointers (g1)), pointers (g2));
+    EXPECT_THAT (dd.changed, IsEmpty ());
+    EXPECT_THAT (dd.root_causes, IsEmpty ());
+}
+
+TEST (Diff, ChangedEdge) {
+    auto const g1 = sample_graph (false);
+    auto const g2 = sample_graph (true);
+    auto const expected = changed_by_digest (g1, g2);
+    EXPECT_THAT (expected, ElementsAre ("a"s, "d"s, "f"s));
+
+    graph_diff const d = diff_graphs (pointers (g1), pointers (g2));
+    EXPECT_THAT (d.added, IsEmpty ());
+    EXPECT_THAT (d.removed, IsEmpty ());
+    EXPECT_EQ (d.changed, expected);
+    EXPECT_THAT (d.root_causes, ElementsAre ("f"s));
+
+    graph_diff const dd = diff_digests (graph_digests (pointers (g1)), pointers (g2));
+    EXPECT_THAT (dd.added, IsEmpty ());
+    EXPECT_THAT (dd.removed, IsEmpty ());
+    EXPECT_EQ (dd.changed, expected);
+    EXPECT_THAT (dd.root_causes, ElementsAre ("f"s));
+}
+
+TEST (Diff, AddedAndRemoved) {
+    auto g1 = sample_graph (false);
+    auto g2 = sample_graph (false);
+    auto const named = [&g2] (char const * const name) {
+        return std::find_if (g2.begin (), g2.end (),
+                             [name] (vertex const & v) { return v.name () == name; });
+    };
+    // Remove 'g' from the new graph and add a vertex 'h' below 'c' (in the loop b -> c -> b).
+    g2.erase (named ("g"));
+    vertex const & vh = g2.emplace_back ("h");
+    named ("c")->add_edge (&vh);
+
+    auto const expected = changed_by_digest (g1, g2);
+    EXPECT_THAT (expected, ElementsAre ("a"s, "b"s, "c"s));
+
+    graph_diff const d = diff_graphs (pointers (g1), pointers (g2));
+    EXPECT_THAT (d.added, ElementsAre ("h"s));
+    EXPECT_THAT (d.removed, ElementsAre ("g"s));
+    EXPECT_EQ (d.changed, expected);
+    EXPECT_THAT (d.root_causes, ElementsAre ("c"s));
+
+    // Without the old graph's structure, the cause can only be narrowed to the loop.
+    graph_diff const dd = diff_digests (graph_digests (pointers (g1)), pointers (g2));
+    EXPECT_THAT (dd.added, ElementsAre ("h"s));
+    EXPECT_THAT (dd.removed, ElementsAre ("g"s));
+    EXPECT_EQ (dd.changed, expected);
+    EXPECT_THAT (dd.root_causes, ElementsAre ("b"s, "c"s));
+}
+
+TEST (Diff, DigestRoundTrip) {
+    auto const g = sample_graph (true);
+    digest_set const digests = graph_digests (pointers (g));
+    std::stringstream str;
+    write_digests (str, digests);
+    EXPECT_EQ (read_digests (str), digests);
+}
+
+TEST (Diff, DuplicateNames) {
+    std::list<vertex> g;
+    g.emplace_back ("a");
+    g.emplace_back ("a");
+    EXPECT_THROW (diff_graphs (pointers (g), pointers (g)), std::invalid_argument);
+}
+
+// The vertices of an unchanged loop are not hashed individually by diff_digests(): the digest of
+// the loop's entry vertex matches so everything beneath it is skipped.
+TEST (Diff, DigestsCutOff) {
+    auto const g1 = make_loops (10U, 10U, false);
+    auto const g2 = make_loops (10U, 10U, true);
+    digest_set const od = graph_digests (pointers (g1));
+
+    auto const before_full = hash::total ();
+    graph_digests (pointers (g2));
+    auto const full_bytes = hash::total () - before_full;
+
+    auto const before_diff = hash::total ();
+    graph_diff const dd = diff_digests (od, pointers (g2));
+    auto const diff_bytes = hash::total () - before_diff;
+
+    EXPECT_EQ (dd.changed, changed_by_digest (g1, g2));
+    EXPECT_THAT (dd.root_causes, testing::Not (IsEmpty ()));
+    EXPECT_LT (diff_bytes * 2U, full_bytes);
+}
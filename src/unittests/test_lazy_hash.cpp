@@ -0,0 +1,190 @@
+#include "lazy_hash.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "config.hpp"
+#include "file_source.hpp"
+#include "graph_description.hpp"
+#include "hash.hpp"
+
+using namespace std::string_literals;
+
+using testing::ElementsAreArray;
+using testing::Gt;
+using testing::Le;
+
+namespace {
+
+    /// Hashes each vertex of the graph described by \p desc using lazy_vertex_hash().
+    std::vector<hash::digest> lazy_digests (graph_description const & desc,
+                                            std::chrono::microseconds latency = {}) {
+        file_source source{write_graph (desc, "lazy_hash_graph.txt"), latency};
+        std::vector<hash::digest> result;
+        lazy_memoized_hashes table;
+        for (auto v = vertex_id{0}; v < source.size (); ++v) {
+            result.push_back (lazy_vertex_hash (source, v, &table));
+        }
+        return result;
+    }
+
+    /// An in-memory graph_source which records the number of fetches which have been issued but
+    /// whose futures have not yet been released by the caller.
+    class counting_source final : public graph_source {
+    public:
+        explicit counting_source (graph_description const & desc)
+                : desc_{desc} {}
+
+        std::shared_future<vertex_record> fetch (vertex_id const v) override {
+            auto const & [name, out_edges] = desc_.at (v);
+            // The token is owned by the future's shared state and so is destroyed when the last
+            // copy of the future is released.
+            auto token = std::make_unique<outstanding> (this);
+            return std::async (std::launch::deferred,
+                               [record = vertex_record{name, out_edges}, t = std::move (token)] {
+                                   return record;
+                               })
+                .share ();
+        }
+
+        /// Returns the largest number of fetches which were outstanding at any one time.
+        std::size_t peak () const noexcept { return peak_; }
+        /// Returns the number of fetches which are currently outstanding.
+        std::size_t outstanding_fetches () const noexcept { return outstanding_; }
+
+    private:
+        class outstanding {
+        public:
+            explicit outstanding (counting_source * const source)
+                    : source_{source} {
+                source_->peak_ = std::max (source_->peak_, ++source_->outstanding_);
+            }
+            outstanding (outstanding const &) = delete;
+            outstanding & operator= (outstanding const &) = delete;
+            ~outstanding () noexcept { --source_->outstanding_; }
+
+        private:
+            counting_source * const source_;
+        };
+
+        graph_description const & desc_;
+        std::size_t outstanding_ = 0;
+        std::size_t peak_ = 0;
+    };
+
+} // end anonymous namespace
+
+TEST (LazyHash, FileSourceRead) {
+    file_source source{write_graph ({{"a"s, {1U, 1U}}, {"b"s, {}}}, "file_source_graph.txt")};
+    ASSERT_EQ (source.size (), 2U);
+    vertex_record const a = source.fetch (0U).get ();
+    EXPECT_EQ (a.name, "a");
+    EXPECT_THAT (a.out_edges, ElementsAreArray ({vertex_id{1}, vertex_id{1}}));
+    vertex_record const b = source.read (1U);
+    EXPECT_EQ (b.name, "b");
+    EXPECT_TRUE (b.out_edges.empty ());
+    EXPECT_THROW (source.fetch (2U), std::out_of_range);
+}
+
+//     digraph G {
+//         c -> a;
+//         c -> b;
+//     }
+TEST (LazyHash, Simple) {
+    graph_description const desc{{"a"s, {}}, {"b"s, {}}, {"c"s, {0U, 1U}}};
+    auto const digests = lazy_digests (desc);
+    EXPECT_THAT (digests, ElementsAreArray (in_memory_digests (desc)));
+#ifndef FNV1_HASH_ENABLED
+    EXPECT_THAT (digests, ElementsAreArray ({"VaE"s, "VbE"s, "Vc/VaE/VbEE"s}));
+#endif
+}
+
+//     digraph G {
+//         g -> c -> b -> a -> c;
+//         g -> f -> e -> d -> f;
+//     }
+TEST (LazyHash, TwoLoops) {
+    graph_description const desc{{"a"s, {2U}},     {"b"s, {0U}}, {"c"s, {1U}},
+                                 {"d"s, {5U}},     {"e"s, {3U}}, {"f"s, {4U}},
+                                 {"g"s, {2U, 5U}}};
+    EXPECT_THAT (lazy_digests (desc), ElementsAreArray (in_memory_digests (desc)));
+}
+
+//     digraph G {
+//         a -> b -> c -> b;
+//         a -> d -> e;
+//         d -> f;
+//         f -> f;
+//     }
+TEST (LazyHash, CyclicAndAcyclicPaths) {
+    graph_description const desc{{"a"s, {1U, 3U}}, {"b"s, {2U}}, {"c"s, {1U}},
+                                 {"d"s, {4U, 5U}}, {"e"s, {}},   {"f"s, {5U}}};
+    EXPECT_THAT (lazy_digests (desc), ElementsAreArray (in_memory_digests (desc)));
+}
+
+//     digraph G {
+//         a -> b -> a;
+//         a -> c -> b;
+//     }
+TEST (LazyHash, DoubleLoopWithLatency) {
+    graph_description const desc{{"a"s, {1U, 2U}}, {"b"s, {0U}}, {"c"s, {1U}}};
+    EXPECT_THAT (lazy_digests (desc, std::chrono::microseconds{100}),
+                 ElementsAreArray (in_memory_digests (desc)));
+}
+
+// A vertex with a very large number of successors must not exhaust the source's resources: the
+// number of outstanding fetches is limited.
+TEST (LazyHash, WideFanOut) {
+    constexpr auto width = vertex_id{60000};
+    graph_description desc;
+    desc.reserve (width + 1U);
+    std::vector<vertex_id> out;
+    out.reserve (width);
+    for (auto v = vertex_id{1}; v <= width; ++v) {
+        out.push_back (v);
+    }
+    desc.emplace_back ("root"s, std::move (out));
+    for (auto v = vertex_id{1}; v <= width; ++v) {
+        desc.emplace_back ("v" + std::to_string (v), std::vector<vertex_id>{});
+    }
+
+    file_source source{write_graph (desc, "lazy_hash_wide.txt")};
+    lazy_memoized_hashes table;
+    EXPECT_EQ (lazy_vertex_hash (source, 0U, &table), in_memory_digests (desc).front ());
+    EXPECT_EQ (table.size (), width + 1U);
+}
+
+// The number of fetches which have been issued but not consumed never exceeds the prefetch window,
+// however many successors are waiting to be hashed at each level of the traversal.
+TEST (LazyHash, PrefetchWindow) {
+    constexpr auto width = vertex_id{100};
+    graph_description desc;
+    std::vector<vertex_id> children;
+    for (auto c = vertex_id{1}; c <= width; ++c) {
+        children.push_back (c);
+    }
+    desc.emplace_back ("root"s, std::move (children));
+    for (auto c = vertex_id{1}; c <= width; ++c) {
+        std::vector<vertex_id> leaves;
+        for (auto l = vertex_id{0}; l < width; ++l) {
+            leaves.push_back (width + 1U + (c - 1U) * width + l);
+        }
+        desc.emplace_back ("c" + std::to_string (c), std::move (leaves));
+    }
+    for (auto l = vertex_id{0}; l < width * width; ++l) {
+        desc.emplace_back ("l" + std::to_string (l), std::vector<vertex_id>{});
+    }
+
+    counting_source source{desc};
+    lazy_memoized_hashes table;
+    EXPECT_EQ (lazy_vertex_hash (source, 0U, &table), in_memory_digests (desc).front ());
+    EXPECT_THAT (source.peak (), Le (lazy_prefetch_window));
+    EXPECT_THAT (source.peak (), Gt (1U));
+    EXPECT_EQ (source.outstanding_fetches (), 0U);
+}
@@ -5,11 +5,14 @@
 #include <iterator>
 #include <list>
 #include <set>
+#include <vector>
 
 #include <gmock/gmock.h>
 
 #include "config.hpp"
+#include "graph_description.hpp"
 #include "hash.hpp"
+#include "sharing_points.hpp"
 #include "vertex.hpp"
 
 using namespace std::string_literals;
@@ -30,6 +33,87 @@ namespace {
 
     using graph_digests = std::vector<std::tuple<vertex const *, hash::digest>>;
 
+    /// Returns the vertices of \p graph from which all of the others can be reached: those with no
+    /// predecessors followed by, in the graph's order, a vertex of each loop that cannot otherwise
+    /// be reached.
+    std::vector<vertex const *> minimal_roots (std::list<vertex> const & graph) {
+        std::set<vertex const *> has_predecessor;
+        for (vertex const & v : graph) {
+            for (vertex const * const out : v.out_edges ()) {
+                if (out != &v) {
+                    has_predecessor.insert (out);
+                }
+            }
+        }
+        std::vector<vertex const *> roots;
+        std::set<vertex const *> reached;
+        auto const reach = [&reached] (vertex const * const v) {
+            std::vector<vertex const *> work{v};
+            while (!work.empty ()) {
+                vertex const * const w = work.back ();
+                work.pop_back ();
+                if (reached.insert (w).second) {
+                    work.insert (std::end (work), std::begin (w->out_edges ()),
+                                 std::end (w->out_edges ()));
+                }
+            }
+        };
+        for (vertex const & v : graph) {
+            if (has_predecessor.count (&v) == 0U) {
+                roots.push_back (&v);
+                reach (&v);
+            }
+        }
+        for (vertex const & v : graph) {
+            if (reached.count (&v) == 0U) {
+                roots.push_back (&v);
+                reach (&v);
+            }
+        }
+        return roots;
+    }
+
+    /// Hashes \p roots both normally and in memo-sparse mode. Checks that the latter produces the
+    /// same digests, hashes the same number of bytes, and stores \p expected_skipped fewer
+    /// digests.
+    void expect_sparse_hashing (std::list<vertex> const & graph,
+                                std::vector<vertex const *> const & roots,
+                                std::size_t const expected_skipped) {
+        memoized_hashes table;
+        auto const before_default = hash::total ();
+        std::vector<hash::digest> expected;
+        for (vertex const * const v : roots) {
+            expected.push_back (vertex_hash (v, &table));
+        }
+        auto const default_bytes = hash::total () - before_default;
+
+        memoized_hashes sparse_table;
+        sharing_points sparse{pointers (graph), roots};
+        auto const before_sparse = hash::total ();
+        for (auto index = std::size_t{0}; index < roots.size (); ++index) {
+            EXPECT_EQ (vertex_hash (roots[index], &sparse_table, nullptr, &sparse),
+                       expected[index])
+                << "Memo-sparse digest of " << *roots[index] << " should be unchanged";
+        }
+        EXPECT_EQ (hash::total () - before_sparse, default_bytes);
+
+        for (auto const & [v, digest] : sparse_table) {
+            EXPECT_EQ (digest, table.at (v)) << "Memo-sparse digest of " << *v;
+        }
+        EXPECT_EQ (sparse.stored (), sparse_table.size ());
+        EXPECT_EQ (sparse.skipped (), expected_skipped);
+        EXPECT_EQ (sparse_table.size () + expected_skipped, table.size ());
+    }
+
+    /// Checks that memo-sparse mode produces the same digests as the default mode for every vertex
+    /// of \p graph, and that when only the minimal set of roots is requested it does the same work
+    /// but stores \p expected_skipped fewer digests.
+    void expect_sparse_digests_unchanged (std::list<vertex> const & graph,
+                                          std::size_t const expected_skipped) {
+        expect_sparse_hashing (graph, pointers (graph), 0U);
+        expect_sparse_hashing (graph, minimal_roots (graph), expected_skipped);
+    }
+
     /// \tparam Iterator An iterator type which will produce an instance of type vertex.
     template <typename Iterator>
     auto hash_vertices (Iterator first, Iterator last)
@@ -82,6 +166,8 @@ TEST (DigraphHash, Simple) {
     vertex const & vb = graph.emplace_back ("b");
     vertex const & vc = graph.emplace_back ("c").add_edge ({&va, &vb}); // c -> a; c -> b;
 
+    expect_sparse_digests_unchanged (graph, 2U);
+
     auto const expected_cache = UnorderedElementsAre (&va, &vb, &vc);
 #ifndef FNV1_HASH_ENABLED
     auto const expected_digests =
@@ -117,6 +203,8 @@ TEST (DigraphHash, SelfLoop) {
     va.add_edge (&vb); // a -> b;
     vb.add_edge (&vb); // b -> b;
 
+    expect_sparse_digests_unchanged (graph, 1U);
+
     auto const expected_cache = UnorderedElementsAre (&va, &vb);
 #ifndef FNV1_HASH_ENABLED
     auto const expected_digests =
@@ -156,6 +244,8 @@ TEST (DigraphHash, TinyLoop) {
         ElementsAre (std::make_tuple (&va, "Va/Vb/R1EE"s), std::make_tuple (&vb, "Vb/Va/R1EE"s));
 #endif
 
+    expect_sparse_digests_unchanged (graph, 0U);
+
     // Forward
     auto const forward_result = hash_vertices (std::begin (graph), std::end (graph));
     EXPECT_EQ (std::get<memoized_hashes> (forward_result).size (), 0U)
@@ -187,6 +277,8 @@ TEST (DigraphHash, Loop2) {
     vertex const & vc = graph.emplace_back ("c").add_edge (&va); // c -> a;
     vertex const & vd = graph.emplace_back ("d").add_edge (&vc); // d -> c;
 
+    expect_sparse_digests_unchanged (graph, 1U);
+
     auto const expected_cache = UnorderedElementsAre (&vc, &vd);
 #ifndef FNV1_HASH_ENABLED
     auto const expected_digests = ElementsAre (
@@ -228,6 +320,8 @@ TEST (DigraphHash, TwoLoops) {
     vd.add_edge (&vf);                                                  // d -> f
     vertex const & vg = graph.emplace_back ("g").add_edge ({&vc, &vf}); // g -> c; g -> f;
 
+    expect_sparse_digests_unchanged (graph, 0U);
+
     auto const expected_cache = UnorderedElementsAre (&vg);
 #ifndef FNV1_HASH_ENABLED
     auto const expected_digests = ElementsAre (
@@ -268,6 +362,8 @@ TEST (DigraphHash, TwoIslands) {
     vertex const & vd = graph.emplace_back ("d");
     vc.add_edge (&vd);
 
+    expect_sparse_digests_unchanged (graph, 1U);
+
     auto const expected_cache = UnorderedElementsAre (&vc, &vd);
 #ifndef FNV1_HASH_ENABLED
     auto const expected_digests =
@@ -312,6 +408,8 @@ TEST (DigraphHash, CyclicAndAcyclicPaths) {
     vertex const & vf = graph.emplace_back ("f");
     vd.add_edge (&vf);
 
+    expect_sparse_digests_unchanged (graph, 3U);
+
     auto const result = hash_vertices (std::begin (graph), std::end (graph));
     EXPECT_THAT (keys (std::get<memoized_hashes> (result)),
                  UnorderedElementsAre (&va, &vd, &ve, &vf));
@@ -336,6 +434,7 @@ TEST (DigraphHash, TwoEdges) {
     vertex & vb = graph.emplace_back ("b");
     va.add_edge (&vb);
     va.add_edge (&vb);
+    expect_sparse_digests_unchanged (graph, 0U);
     {
         memoized_hashes ma;
         hash::digest const hva = vertex_hash (&va, &ma);
@@ -365,6 +464,7 @@ TEST (DigraphHash, Diamond) {
     va.add_edge (&vc);
     vc.add_edge (&vd);
 
+    expect_sparse_digests_unchanged (graph, 2U);
     {
         memoized_hashes ma;
         hash::digest const hva = vertex_hash (&va, &ma);
@@ -408,6 +508,7 @@ TEST (DigraphHash, TwiceVisitedLoop) {
     va.add_edge (&vd);
     vd.add_edge (&vb);
 
+    expect_sparse_digests_unchanged (graph, 1U);
     {
         memoized_hashes ma;
         hash::digest const hva = vertex_hash (&va, &ma);
@@ -448,6 +549,7 @@ TEST (DigraphHash, DoubleLoop) {
     vb.add_edge (&va);
     va.add_edge (&vc);
     vc.add_edge (&vb);
+    expect_sparse_digests_unchanged (graph, 0U);
     {
         memoized_hashes ma;
         hash::digest const hva = vertex_hash (&va, &ma);
@@ -0,0 +1,98 @@
+#include "profile.hpp"
+
+#include <list>
+#include <sstream>
+#include <string>
+
+#include <gmock/gmock.h>
+
+#include "memhash.hpp"
+#include "vertex.hpp"
+
+using testing::HasSubstr;
+
+namespace {
+
+    vertex_profile const & profile_of (hash_profile const & p, vertex const & v) {
+        return p.vertices ().at (&v);
+    }
+
+} // end anonymous namespace
+
+// A loop which is reached from two entry points and must therefore be walked twice.
+//     digraph G {
+//         a -> b -> c -> b;
+//         a -> d -> b;
+//     }
+TEST (Profile, TwiceVisitedLoop) {
+    std::list<vertex> graph;
+    vertex & va = graph.emplace_back ("a");
+    vertex & vb = graph.emplace_back ("b");
+    vertex & vc = graph.emplace_back ("c");
+    vertex & vd = graph.emplace_back ("d");
+    va.add_edge (&vb);
+    vb.add_edge (&vc);
+    vc.add_edge (&vb);
+    va.add_edge (&vd);
+    vd.add_edge (&vb);
+
+    hash_profile profile;
+    memoized_hashes table;
+    vertex_hash (&va, &table, &profile);
+    EXPECT_EQ (profile.vertices ().size (), 4U);
+
+    vertex_profile const & pa = profile_of (profile, va);
+    EXPECT_EQ (pa.visits, 1U);
+    EXPECT_TRUE (pa.memoized);
+    EXPECT_GT (pa.bytes, 0U);
+
+    vertex_profile const & pb = profile_of (profile, vb);
+    EXPECT_EQ (pb.visits, 2U);
+    EXPECT_EQ (pb.backrefs, 2U);
+    EXPECT_FALSE (pb.memoized);
+
+    vertex_profile const & pc = profile_of (profile, vc);
+    EXPECT_EQ (pc.visits, 2U);
+    EXPECT_EQ (pc.backrefs, 0U);
+    EXPECT_FALSE (pc.memoized);
+
+    // Hashing 'd' again finds its memoized digest.
+    vertex_hash (&vd, &table, &profile);
+    EXPECT_EQ (profile_of (profile, vd).visits, 1U);
+    EXPECT_EQ (profile_of (profile, vd).memo_hits, 1U);
+
+    std::ostringstream report;
+    profile.report (report);
+    EXPECT_THAT (report.str (), HasSubstr ("Non-memoizable regions"));
+    EXPECT_THAT (report.str (), HasSubstr ("#1 "));
+    EXPECT_THAT (report.str (), HasSubstr (" b c\n"));
+
+    std::ostringstream dot;
+    profile.write_dot (dot);
+    EXPECT_THAT (dot.str (), HasSubstr ("subgraph cluster_1 {"));
+    EXPECT_THAT (dot.str (), HasSubstr ("v1 -> v2;"));
+}
+
+//     digraph G {
+//         c -> a;
+//         c -> b;
+//     }
+TEST (Profile, NoLoops) {
+    std::list<vertex> graph;
+    vertex const & va = graph.emplace_back ("a");
+    vertex const & vb = graph.emplace_back ("b");
+    vertex const & vc = graph.emplace_back ("c").add_edge ({&va, &vb});
+
+    hash_profile profile;
+    memoized_hashes table;
+    for (vertex const & v : graph) {
+        vertex_hash (&v, &table, &profile);
+    }
+    EXPECT_EQ (profile_of (profile, va).visits, 1U);
+    EXPECT_EQ (profile_of (profile, va).memo_hits, 1U);
+    EXPECT_EQ (profile_of (profile, vc).visits, 1U);
+
+    std::ostringstream report;
+    profile.report (report);
+    EXPECT_THAT (report.str (), testing::Not (HasSubstr ("Non-memoizable regions")));
+}
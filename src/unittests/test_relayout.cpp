@@ -0,0 +1,79 @@
+#include "relayout.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "graph_description.hpp"
+#include "hash.hpp"
+#include "memhash.hpp"
+#include "vertex.hpp"
+
+using testing::ElementsAre;
+
+namespace {
+
+    std::vector<std::string> names (relaid_graph const & rg) {
+        std::vector<std::string> result;
+        for (vertex const & v : rg.vertices ()) {
+            result.push_back (v.name ());
+        }
+        return result;
+    }
+
+} // end anonymous namespace
+
+// The tests use sample_graph():
+//
+//     digraph G {
+//         a -> b -> c -> b;
+//         a -> d -> e;
+//         d -> f;
+//         g -> e;
+//     }
+TEST (Relayout, DepthFirst) {
+    auto const graph = sample_graph ();
+    relaid_graph const rg{pointers (graph), layout_order::depth_first};
+    EXPECT_THAT (names (rg), ElementsAre ("a", "b", "c", "d", "e", "f", "g"));
+}
+
+TEST (Relayout, BreadthFirst) {
+    auto const graph = sample_graph ();
+    relaid_graph const rg{pointers (graph), layout_order::breadth_first};
+    EXPECT_THAT (names (rg), ElementsAre ("a", "b", "d", "c", "e", "f", "g"));
+}
+
+TEST (Relayout, ReverseCuthillMcKee) {
+    auto const graph = sample_graph ();
+    relaid_graph const rg{pointers (graph), layout_order::reverse_cuthill_mckee};
+    EXPECT_EQ (rg.vertices ().size (), graph.size ());
+    // The graph is connected, so the traversal starts at a vertex of minimum degree (the first
+    // such, 'g') and so ends there once reversed.
+    EXPECT_EQ (rg.vertices ().back ().name (), "g");
+}
+
+TEST (Relayout, DigestsAreUnchanged) {
+    auto const graph = sample_graph ();
+    for (layout_order const order : {layout_order::depth_first, layout_order::breadth_first,
+                                     layout_order::reverse_cuthill_mckee}) {
+        relaid_graph const rg{pointers (graph), order};
+        memoized_hashes original_table;
+        memoized_hashes relaid_table;
+        for (vertex const & v : graph) {
+            vertex const * const copy = rg.relaid (&v);
+            EXPECT_EQ (copy->name (), v.name ());
+            EXPECT_EQ (rg.original (copy), &v);
+            EXPECT_EQ (vertex_hash (copy, &relaid_table), vertex_hash (&v, &original_table));
+        }
+    }
+}
+
+TEST (Relayout, ClosedGraph) {
+    auto const graph = sample_graph ();
+    auto p = pointers (graph);
+    ASSERT_EQ (p.back ()->name (), "d");
+    p.pop_back (); // 'a' has an edge to 'd' which is no longer part of the graph.
+    EXPECT_THROW (relaid_graph (p, layout_order::depth_first), std::invalid_argument);
+}
@@ -0,0 +1,147 @@
+#include "sharded_hash.hpp"
+
+#include <string>
+
+#include <gmock/gmock.h>
+
+#include "graph_description.hpp"
+
+using namespace std::string_literals;
+
+using testing::ElementsAreArray;
+using testing::Le;
+
+namespace {
+
+    /// Hashes the graph described by \p desc using sharded_vertex_hash() with \p shards workers.
+    std::vector<hash::digest> sharded_digests (graph_description const & desc, unsigned shards,
+                                               std::vector<shard_stats> * const stats = nullptr) {
+        return sharded_vertex_hash (write_graph (desc, "sharded_hash_graph.txt"), shards, stats);
+    }
+
+    /// Returns the total number of vertices owned by the shards.
+    std::size_t total_vertices (std::vector<shard_stats> const & stats) {
+        std::size_t total = 0;
+        for (shard_stats const & s : stats) {
+            total += s.vertices;
+        }
+        return total;
+    }
+
+} // end anonymous namespace
+
+//     digraph G {
+//         a -> b -> d;
+//         a -> c -> d;
+//     }
+TEST (ShardedHash, Diamond) {
+    graph_description const desc{{"a"s, {1U, 2U}}, {"b"s, {3U}}, {"c"s, {3U}}, {"d"s, {}}};
+    auto const expected = in_memory_digests (desc);
+    for (auto shards = 1U; shards <= 4U; ++shards) {
+        EXPECT_THAT (sharded_digests (desc, shards), ElementsAreArray (expected))
+            << "with " << shards << " shards";
+    }
+}
+
+// Cycles which cross shard boundaries.
+//
+//     digraph G {
+//         g -> c -> b -> a -> c;
+//         g -> f -> e -> d -> f;
+//         h -> g;
+//         i -> h;
+//         i -> a;
+//     }
+TEST (ShardedHash, TwoLoops) {
+    graph_description const desc{{"a"s, {2U}},     {"b"s, {0U}}, {"c"s, {1U}},
+                                 {"d"s, {5U}},     {"e"s, {3U}}, {"f"s, {4U}},
+                                 {"g"s, {2U, 5U}}, {"h"s, {6U}}, {"i"s, {7U, 0U}}};
+    auto const expected = in_memory_digests (desc);
+    for (auto shards = 1U; shards <= 4U; ++shards) {
+        EXPECT_THAT (sharded_digests (desc, shards), ElementsAreArray (expected))
+            << "with " << shards << " shards";
+    }
+}
+
+//     digraph G {
+//         a -> b -> a;
+//         a -> c -> b;
+//         d -> a;
+//         d -> d;
+//     }
+TEST (ShardedHash, DoubleLoop) {
+    graph_description const desc{{"a"s, {1U, 2U}}, {"b"s, {0U}}, {"c"s, {1U}}, {"d"s, {0U, 3U}}};
+    auto const expected = in_memory_digests (desc);
+    for (auto shards = 1U; shards <= 4U; ++shards) {
+        EXPECT_THAT (sharded_digests (desc, shards), ElementsAreArray (expected))
+            << "with " << shards << " shards";
+    }
+}
+
+// Loops which cross shard boundaries and are reached from one another.
+//
+//     digraph G {
+//         a -> b -> c -> a;
+//         c -> d;
+//         d -> e -> f -> d;
+//         f -> g;
+//         h -> a;
+//     }
+TEST (ShardedHash, ChainedLoops) {
+    graph_description const desc{{"a"s, {1U}}, {"b"s, {2U}}, {"c"s, {0U, 3U}}, {"d"s, {4U}},
+                                 {"e"s, {5U}}, {"f"s, {3U, 6U}}, {"g"s, {}}, {"h"s, {0U}}};
+    auto const expected = in_memory_digests (desc);
+    for (auto shards = 1U; shards <= 4U; ++shards) {
+        std::vector<shard_stats> stats;
+        EXPECT_THAT (sharded_digests (desc, shards, &stats), ElementsAreArray (expected))
+            << "with " << shards << " shards";
+        ASSERT_EQ (stats.size (), shards);
+        EXPECT_EQ (total_vertices (stats), desc.size ());
+        for (shard_stats const & s : stats) {
+            // Members of loops are never memoized; other shards' vertices are never memoized.
+            EXPECT_THAT (s.memoized, Le (s.vertices)) << "with " << shards << " shards";
+        }
+    }
+}
+
+// Each worker hashes only its own vertices: an acyclic graph needs no records from other shards.
+TEST (ShardedHash, ShardsHashOwnVertices) {
+    graph_description desc;
+    for (vertex_id v = 0U; v < 20U; ++v) {
+        std::vector<vertex_id> out;
+        for (vertex_id w = v + 1U; w < 20U && w <= v + 3U; ++w) {
+            out.push_back (w);
+        }
+        desc.emplace_back ("v"s + std::to_string (v), std::move (out));
+    }
+    auto const expected = in_memory_digests (desc);
+    for (auto shards = 1U; shards <= 4U; ++shards) {
+        std::vector<shard_stats> stats;
+        EXPECT_THAT (sharded_digests (desc, shards, &stats), ElementsAreArray (expected))
+            << "with " << shards << " shards";
+        ASSERT_EQ (stats.size (), shards);
+        EXPECT_EQ (total_vertices (stats), desc.size ());
+        for (auto k = 0U; k < shards; ++k) {
+            EXPECT_EQ (stats[k].memoized, stats[k].vertices) << "shard " << k << " of " << shards;
+            EXPECT_EQ (stats[k].remote_records, 0U) << "shard " << k << " of " << shards;
+        }
+    }
+}
+
+TEST (ShardedHash, NoShards) {
+    EXPECT_THROW (sharded_digests ({{"a"s, {}}}, 0U), std::invalid_argument);
+}
+
+// A worker which fails reports the reason to the caller, even though the other workers see only
+// a closed connection.
+TEST (ShardedHash, WorkerFailure) {
+    // Vertex "b" belongs to shard 1 and has an edge to a vertex which does not exist.
+    graph_description const desc{{"a"s, {1U}}, {"b"s, {7U}}};
+    try {
+        sharded_digests (desc, 2U);
+        ADD_FAILURE () << "sharded_vertex_hash() should have thrown";
+    } catch (std::runtime_error const & ex) {
+        EXPECT_THAT (ex.what (), testing::HasSubstr ("shard 1: vertex \"b\" has an edge to an "
+                                                     "unknown vertex"));
+    }
+}
@@ -0,0 +1,135 @@
+#include "sharing_points.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "graph_description.hpp"
+#include "hash.hpp"
+#include "memhash.hpp"
+#include "vertex.hpp"
+
+using testing::UnorderedElementsAre;
+
+//     digraph G {
+//         a -> b -> c -> d -> d;
+//         a -> e -> d;
+//     }
+TEST (SharingPoints, InDegree) {
+    std::list<vertex> graph;
+    vertex & va = graph.emplace_back ("a");
+    vertex & vb = graph.emplace_back ("b");
+    vertex & vc = graph.emplace_back ("c");
+    vertex & vd = graph.emplace_back ("d");
+    vertex & ve = graph.emplace_back ("e");
+    va.add_edge ({&vb, &ve});
+    vb.add_edge (&vc);
+    vc.add_edge (&vd);
+    vd.add_edge (&vd);
+    ve.add_edge (&vd);
+
+    sharing_points const sp{pointers (graph), {&vc}};
+    EXPECT_FALSE (sp.contains (&va));
+    EXPECT_FALSE (sp.contains (&vb));
+    EXPECT_TRUE (sp.contains (&vc));
+    EXPECT_TRUE (sp.contains (&vd));
+    EXPECT_FALSE (sp.contains (&ve));
+}
+
+// The counters show how many digests were not stored.
+//
+//     digraph G {
+//         a -> b -> c -> d;
+//         a -> e -> d;
+//     }
+TEST (SharingPoints, Counters) {
+    std::list<vertex> graph;
+    vertex & va = graph.emplace_back ("a");
+    vertex & vb = graph.emplace_back ("b");
+    vertex & vc = graph.emplace_back ("c");
+    vertex & vd = graph.emplace_back ("d");
+    vertex & ve = graph.emplace_back ("e");
+    va.add_edge ({&vb, &ve});
+    vb.add_edge (&vc);
+    vc.add_edge (&vd);
+    ve.add_edge (&vd);
+
+    memoized_hashes full;
+    auto const expected = vertex_hash (&va, &full);
+    EXPECT_EQ (full.size (), 5U);
+
+    // Only the root and the vertex with two predecessors are stored.
+    {
+        memoized_hashes table;
+        sharing_points sp{pointers (graph), {&va}};
+        EXPECT_EQ (vertex_hash (&va, &table, nullptr, &sp), expected);
+        EXPECT_THAT (table, UnorderedElementsAre (testing::Key (&va), testing::Key (&vd)));
+        EXPECT_EQ (sp.stored (), 2U);
+        EXPECT_EQ (sp.skipped (), 3U);
+    }
+    // A vertex which will be requested as a root is stored.
+    {
+        memoized_hashes table;
+        sharing_points sp{pointers (graph), {&va, &vb}};
+        EXPECT_EQ (vertex_hash (&va, &table, nullptr, &sp), expected);
+        EXPECT_EQ (vertex_hash (&vb, &table, nullptr, &sp), full.at (&vb));
+        EXPECT_THAT (table, UnorderedElementsAre (testing::Key (&va), testing::Key (&vb),
+                                                  testing::Key (&vd)));
+        EXPECT_EQ (sp.stored (), 3U);
+        EXPECT_EQ (sp.skipped (), 2U);
+    }
+}
+
+// The successors of a vertex on a loop are stored so that walking the loop again doesn't walk
+// them again too.
+//
+//     digraph G {
+//         e0 -> b;
+//         e1 -> b;
+//         e2 -> b;
+//         b -> c -> b;
+//         c -> x0 -> x1 -> ... -> x9;
+//     }
+TEST (SharingPoints, LoopFeedingChain) {
+    std::list<vertex> graph;
+    vertex & vb = graph.emplace_back ("b");
+    vertex & vc = graph.emplace_back ("c");
+    vb.add_edge (&vc);
+    vc.add_edge (&vb);
+    std::vector<vertex const *> roots;
+    for (auto const * const name : {"e0", "e1", "e2"}) {
+        roots.push_back (&graph.emplace_back (name).add_edge (&vb));
+    }
+    vertex * previous = &vc;
+    std::vector<vertex const *> chain;
+    for (auto index = 0; index < 10; ++index) {
+        vertex & x = graph.emplace_back ("x" + std::to_string (index));
+        previous->add_edge (&x);
+        chain.push_back (&x);
+        previous = &x;
+    }
+
+    auto const before_default = hash::total ();
+    memoized_hashes full;
+    std::vector<hash::digest> expected;
+    for (vertex const * const r : roots) {
+        expected.push_back (vertex_hash (r, &full));
+    }
+    auto const default_bytes = hash::total () - before_default;
+
+    auto const before_sparse = hash::total ();
+    memoized_hashes table;
+    sharing_points sp{pointers (graph), roots};
+    for (auto index = std::size_t{0}; index < roots.size (); ++index) {
+        EXPECT_EQ (vertex_hash (roots[index], &table, nullptr, &sp), expected[index]);
+    }
+    EXPECT_EQ (hash::total () - before_sparse, default_bytes);
+
+    // The head of the chain is stored; the rest of the chain is not.
+    EXPECT_EQ (table.count (chain.front ()), 1U);
+    EXPECT_EQ (table.count (chain.back ()), 0U);
+    EXPECT_EQ (sp.skipped (), chain.size () - 1U);
+    EXPECT_EQ (sp.stored () + sp.skipped (), full.size ());
+}